@@ -0,0 +1,64 @@
+/*
+================================================================================
+  GENERADOR ALEATORIO BASADO EN CONTADOR
+  Arquitectura Paralela con MPI - codigo comun a las practicas
+================================================================================
+
+  El valor del elemento i de una matriz depende solo de (semilla, i), no del
+  orden en que se generan. Asi cada proceso puede rellenar su bloque sin
+  comunicarse y el resultado es identico bit a bit para una semilla dada,
+  se use el numero de procesos que se use.
+
+  La mezcla es la funcion de finalizacion de SplitMix64 aplicada sobre
+  semilla + (i + 1) * constante de Weyl.
+================================================================================
+*/
+
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include <stddef.h>
+#include <time.h>
+
+typedef unsigned long long semilla_t;
+
+// Valor pseudoaleatorio de 64 bits para la posicion 'indice' del flujo 'semilla'
+inline unsigned long long aleatorio_contador(semilla_t semilla, unsigned long long indice)
+{
+    unsigned long long z = semilla + (indice + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Deriva una semilla independiente para cada matriz (A, B, ...) de la semilla global
+inline semilla_t aleatorio_flujo(semilla_t semilla, unsigned int flujo)
+{
+    return aleatorio_contador(semilla ^ 0xD1B54A32D192ED03ULL, flujo);
+}
+
+// Entero en [minimo, maximo] para la posicion 'indice'. Se usan los 32 bits altos
+// escalados al rango, lo que evita el sesgo de "% rango" en los bits bajos
+inline int aleatorio_entero(semilla_t semilla, unsigned long long indice, int minimo, int maximo)
+{
+    unsigned long long alto = aleatorio_contador(semilla, indice) >> 32;
+    unsigned long long rango = (unsigned long long)(maximo - minimo) + 1;
+    return minimo + (int)((alto * rango) >> 32);
+}
+
+// Rellena 'cantidad' elementos consecutivos a partir de la posicion global 'inicio'
+inline void aleatorio_rellenar(int* destino, size_t cantidad, semilla_t semilla,
+    unsigned long long inicio, int minimo, int maximo)
+{
+    for (size_t i = 0; i < cantidad; i++) {
+        destino[i] = aleatorio_entero(semilla, inicio + i, minimo, maximo);
+    }
+}
+
+// Semilla por defecto cuando el usuario no da ninguna
+inline semilla_t aleatorio_semilla_reloj(void)
+{
+    return aleatorio_contador((semilla_t)time(NULL), 0);
+}
+
+#endif
@@ -0,0 +1,400 @@
+/*
+================================================================================
+  NUCLEOS SIMD PARA OPERACIONES ELEMENTO A ELEMENTO
+  Arquitectura Paralela con MPI - codigo comun a las practicas
+================================================================================
+
+  Suma elemento a elemento (c = a + b) y producto escalar (x . y) para int32,
+  int64, float y double, con tres implementaciones:
+  - AVX-512 (requiere AVX-512F y AVX-512DQ)
+  - AVX2
+  - bucle escalar, que sirve en cualquier CPU
+
+  La implementacion se elige una sola vez en tiempo de ejecucion segun lo que
+  soporten la CPU y el sistema operativo, asi el mismo ejecutable funciona en
+  cualquier nodo. simd_forzar_nivel() permite fijar el nivel para comparar.
+
+  Los productos escalares acumulan en 64 bits: int32 -> long long, float ->
+  double. El acumulador entero no desborda mientras sum(|x_i * y_i|) < 2^63.
+  Un producto de dos int32 extremos ya vale 2^62, asi que en el peor caso
+  solo caben 2 terminos; con |x|, |y| <= 2^15 caben unos 2^33.
+================================================================================
+*/
+
+#ifndef KERNELS_SIMD_H
+#define KERNELS_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC permite usar los intrinsecos sin activar /arch: no hacen falta atributos
+#define SIMD_OBJETIVO_AVX2
+#define SIMD_OBJETIVO_AVX512
+#else
+#define SIMD_OBJETIVO_AVX2 __attribute__((target("avx2")))
+#define SIMD_OBJETIVO_AVX512 __attribute__((target("avx512f,avx512dq")))
+#endif
+#endif
+
+enum NivelSimd { SIMD_ESCALAR = 0, SIMD_AVX2 = 1, SIMD_AVX512 = 2 };
+
+inline const char* simd_nombre_nivel(int nivel)
+{
+    static const char* nombres[] = { "escalar", "AVX2", "AVX-512" };
+    return nombres[nivel];
+}
+
+// Deteccion de la CPU: ademas de las instrucciones hay que comprobar que el
+// sistema operativo guarda los registros YMM/ZMM en los cambios de contexto
+inline int simd_detectar_nivel(void)
+{
+#if defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return SIMD_ESCALAR;
+    __cpuid(info, 1);
+    int osxsave = (info[2] >> 27) & 1;
+    int avx = (info[2] >> 28) & 1;
+    if (!osxsave || !avx) return SIMD_ESCALAR;
+    unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) return SIMD_ESCALAR;
+    __cpuidex(info, 7, 0);
+    int avx2 = (info[1] >> 5) & 1;
+    int avx512f = (info[1] >> 16) & 1;
+    int avx512dq = (info[1] >> 17) & 1;
+    if (avx512f && avx512dq && (xcr0 & 0xE6) == 0xE6) return SIMD_AVX512;
+    if (avx2) return SIMD_AVX2;
+    return SIMD_ESCALAR;
+#elif defined(SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    return SIMD_ESCALAR;
+#else
+    return SIMD_ESCALAR;
+#endif
+}
+
+// Nivel en uso: se detecta la primera vez; -1 = sin decidir todavia
+inline int& simd_nivel_actual(void)
+{
+    static int nivel = -1;
+    return nivel;
+}
+
+inline int simd_nivel(void)
+{
+    int& nivel = simd_nivel_actual();
+    if (nivel < 0) {
+        nivel = simd_detectar_nivel();
+    }
+    return nivel;
+}
+
+// Fija el nivel (nunca por encima de lo que soporta la CPU). Devuelve el aplicado
+inline int simd_forzar_nivel(int nivel)
+{
+    int maximo = simd_detectar_nivel();
+    simd_nivel_actual() = nivel < maximo ? nivel : maximo;
+    return simd_nivel_actual();
+}
+
+// =============================================================================
+// VERSIONES ESCALARES (referencia y resto de los bucles vectoriales)
+// =============================================================================
+template <typename T>
+inline void simd_sumar_escalar(const T* a, const T* b, T* c, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+// Acum es el tipo de acumulacion: long long para enteros, double para reales
+template <typename T, typename Acum>
+inline Acum simd_producto_escalar(const T* x, const T* y, size_t n)
+{
+    Acum suma = 0;
+    for (size_t i = 0; i < n; i++) {
+        suma += (Acum)x[i] * (Acum)y[i];
+    }
+    return suma;
+}
+
+#ifdef SIMD_X86
+// =============================================================================
+// AVX2: registros de 256 bits
+// =============================================================================
+SIMD_OBJETIVO_AVX2 inline void simd_sumar_i32_avx2(const int32_t* a, const int32_t* b, int32_t* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(c + i), _mm256_add_epi32(va, vb));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX2 inline void simd_sumar_i64_avx2(const int64_t* a, const int64_t* b, int64_t* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(c + i), _mm256_add_epi64(va, vb));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX2 inline void simd_sumar_f32_avx2(const float* a, const float* b, float* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(c + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX2 inline void simd_sumar_f64_avx2(const double* a, const double* b, double* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(c + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX2 inline long long simd_suma_horizontal_i64_avx2(__m256i v)
+{
+    long long partes[4];
+    _mm256_storeu_si256((__m256i*)partes, v);
+    return partes[0] + partes[1] + partes[2] + partes[3];
+}
+
+SIMD_OBJETIVO_AVX2 inline double simd_suma_horizontal_f64_avx2(__m256d v)
+{
+    double partes[4];
+    _mm256_storeu_pd(partes, v);
+    return (partes[0] + partes[1]) + (partes[2] + partes[3]);
+}
+
+// _mm256_mul_epi32 multiplica los carriles pares con signo y deja productos de
+// 64 bits; los impares se llevan a posicion par desplazando 32 bits
+SIMD_OBJETIVO_AVX2 inline long long simd_producto_i32_avx2(const int32_t* x, const int32_t* y, size_t n)
+{
+    __m256i acum_par = _mm256_setzero_si256();
+    __m256i acum_impar = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i*)(y + i));
+        acum_par = _mm256_add_epi64(acum_par, _mm256_mul_epi32(vx, vy));
+        acum_impar = _mm256_add_epi64(acum_impar,
+            _mm256_mul_epi32(_mm256_srli_epi64(vx, 32), _mm256_srli_epi64(vy, 32)));
+    }
+    long long suma = simd_suma_horizontal_i64_avx2(_mm256_add_epi64(acum_par, acum_impar));
+    return suma + simd_producto_escalar<int32_t, long long>(x + i, y + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX2 inline double simd_producto_f32_avx2(const float* x, const float* y, size_t n)
+{
+    __m256d acum0 = _mm256_setzero_pd();
+    __m256d acum1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        acum0 = _mm256_add_pd(acum0, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(vx)),
+            _mm256_cvtps_pd(_mm256_castps256_ps128(vy))));
+        acum1 = _mm256_add_pd(acum1, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(vx, 1)),
+            _mm256_cvtps_pd(_mm256_extractf128_ps(vy, 1))));
+    }
+    double suma = simd_suma_horizontal_f64_avx2(_mm256_add_pd(acum0, acum1));
+    return suma + simd_producto_escalar<float, double>(x + i, y + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX2 inline double simd_producto_f64_avx2(const double* x, const double* y, size_t n)
+{
+    // Dos acumuladores para no quedar limitados por la latencia de la suma
+    __m256d acum0 = _mm256_setzero_pd();
+    __m256d acum1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acum0 = _mm256_add_pd(acum0, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        acum1 = _mm256_add_pd(acum1, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+    }
+    double suma = simd_suma_horizontal_f64_avx2(_mm256_add_pd(acum0, acum1));
+    return suma + simd_producto_escalar<double, double>(x + i, y + i, n - i);
+}
+
+// =============================================================================
+// AVX-512: registros de 512 bits
+// =============================================================================
+SIMD_OBJETIVO_AVX512 inline void simd_sumar_i32_avx512(const int32_t* a, const int32_t* b, int32_t* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        _mm512_storeu_si512((void*)(c + i), _mm512_add_epi32(va, vb));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX512 inline void simd_sumar_i64_avx512(const int64_t* a, const int64_t* b, int64_t* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        _mm512_storeu_si512((void*)(c + i), _mm512_add_epi64(va, vb));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX512 inline void simd_sumar_f32_avx512(const float* a, const float* b, float* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(c + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX512 inline void simd_sumar_f64_avx512(const double* a, const double* b, double* c, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(c + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    simd_sumar_escalar(a + i, b + i, c + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX512 inline long long simd_producto_i32_avx512(const int32_t* x, const int32_t* y, size_t n)
+{
+    __m512i acum_par = _mm512_setzero_si512();
+    __m512i acum_impar = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i vx = _mm512_loadu_si512((const void*)(x + i));
+        __m512i vy = _mm512_loadu_si512((const void*)(y + i));
+        acum_par = _mm512_add_epi64(acum_par, _mm512_mul_epi32(vx, vy));
+        acum_impar = _mm512_add_epi64(acum_impar,
+            _mm512_mul_epi32(_mm512_srli_epi64(vx, 32), _mm512_srli_epi64(vy, 32)));
+    }
+    long long suma = _mm512_reduce_add_epi64(_mm512_add_epi64(acum_par, acum_impar));
+    return suma + simd_producto_escalar<int32_t, long long>(x + i, y + i, n - i);
+}
+
+// AVX-512DQ aporta la multiplicacion de 64 bits que AVX2 no tiene
+SIMD_OBJETIVO_AVX512 inline long long simd_producto_i64_avx512(const int64_t* x, const int64_t* y, size_t n)
+{
+    __m512i acum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i vx = _mm512_loadu_si512((const void*)(x + i));
+        __m512i vy = _mm512_loadu_si512((const void*)(y + i));
+        acum = _mm512_add_epi64(acum, _mm512_mullo_epi64(vx, vy));
+    }
+    long long suma = _mm512_reduce_add_epi64(acum);
+    return suma + simd_producto_escalar<int64_t, long long>(x + i, y + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX512 inline double simd_producto_f32_avx512(const float* x, const float* y, size_t n)
+{
+    __m512d acum0 = _mm512_setzero_pd();
+    __m512d acum1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 vx = _mm512_loadu_ps(x + i);
+        __m512 vy = _mm512_loadu_ps(y + i);
+        acum0 = _mm512_add_pd(acum0, _mm512_mul_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(vx)),
+            _mm512_cvtps_pd(_mm512_castps512_ps256(vy))));
+        acum1 = _mm512_add_pd(acum1, _mm512_mul_pd(
+            _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(vx), 1))),
+            _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(vy), 1)))));
+    }
+    double suma = _mm512_reduce_add_pd(_mm512_add_pd(acum0, acum1));
+    return suma + simd_producto_escalar<float, double>(x + i, y + i, n - i);
+}
+
+SIMD_OBJETIVO_AVX512 inline double simd_producto_f64_avx512(const double* x, const double* y, size_t n)
+{
+    __m512d acum0 = _mm512_setzero_pd();
+    __m512d acum1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acum0 = _mm512_add_pd(acum0, _mm512_mul_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+        acum1 = _mm512_add_pd(acum1, _mm512_mul_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8)));
+    }
+    double suma = _mm512_reduce_add_pd(_mm512_add_pd(acum0, acum1));
+    return suma + simd_producto_escalar<double, double>(x + i, y + i, n - i);
+}
+#endif
+
+// =============================================================================
+// PUNTOS DE ENTRADA CON DESPACHO SEGUN EL NIVEL DETECTADO
+// =============================================================================
+#ifdef SIMD_X86
+#define SIMD_DESPACHAR(avx512, avx2, escalar) \
+    switch (simd_nivel()) {                  \
+    case SIMD_AVX512: return avx512;         \
+    case SIMD_AVX2: return avx2;             \
+    default: return escalar;                 \
+    }
+#else
+#define SIMD_DESPACHAR(avx512, avx2, escalar) return escalar;
+#endif
+
+inline void simd_sumar(const int32_t* a, const int32_t* b, int32_t* c, size_t n)
+{
+    SIMD_DESPACHAR(simd_sumar_i32_avx512(a, b, c, n), simd_sumar_i32_avx2(a, b, c, n), simd_sumar_escalar(a, b, c, n))
+}
+
+inline void simd_sumar(const int64_t* a, const int64_t* b, int64_t* c, size_t n)
+{
+    SIMD_DESPACHAR(simd_sumar_i64_avx512(a, b, c, n), simd_sumar_i64_avx2(a, b, c, n), simd_sumar_escalar(a, b, c, n))
+}
+
+inline void simd_sumar(const float* a, const float* b, float* c, size_t n)
+{
+    SIMD_DESPACHAR(simd_sumar_f32_avx512(a, b, c, n), simd_sumar_f32_avx2(a, b, c, n), simd_sumar_escalar(a, b, c, n))
+}
+
+inline void simd_sumar(const double* a, const double* b, double* c, size_t n)
+{
+    SIMD_DESPACHAR(simd_sumar_f64_avx512(a, b, c, n), simd_sumar_f64_avx2(a, b, c, n), simd_sumar_escalar(a, b, c, n))
+}
+
+inline long long simd_producto(const int32_t* x, const int32_t* y, size_t n)
+{
+    SIMD_DESPACHAR(simd_producto_i32_avx512(x, y, n), simd_producto_i32_avx2(x, y, n),
+        (simd_producto_escalar<int32_t, long long>(x, y, n)))
+}
+
+// Sin multiplicacion de 64 bits en AVX2, ese nivel usa el bucle escalar
+inline long long simd_producto(const int64_t* x, const int64_t* y, size_t n)
+{
+    SIMD_DESPACHAR(simd_producto_i64_avx512(x, y, n), (simd_producto_escalar<int64_t, long long>(x, y, n)),
+        (simd_producto_escalar<int64_t, long long>(x, y, n)))
+}
+
+inline double simd_producto(const float* x, const float* y, size_t n)
+{
+    SIMD_DESPACHAR(simd_producto_f32_avx512(x, y, n), simd_producto_f32_avx2(x, y, n),
+        (simd_producto_escalar<float, double>(x, y, n)))
+}
+
+inline double simd_producto(const double* x, const double* y, size_t n)
+{
+    SIMD_DESPACHAR(simd_producto_f64_avx512(x, y, n), simd_producto_f64_avx2(x, y, n),
+        (simd_producto_escalar<double, double>(x, y, n)))
+}
+
+#endif
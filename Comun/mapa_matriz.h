@@ -0,0 +1,320 @@
+/*
+================================================================================
+  LECTURA DE MATRICES BINARIAS PROYECTADAS EN MEMORIA
+  Arquitectura Paralela con MPI - codigo comun a las practicas
+================================================================================
+
+  Para analizar en un solo nodo los ficheros .mat de matriz_binaria.h sin
+  cargarlos enteros en memoria. El fichero se proyecta en el espacio de
+  direcciones (mmap en POSIX, MapViewOfFile en Windows) y se accede a los
+  elementos directamente en las paginas del sistema de ficheros, sin copias:
+
+    mapa_abrir / mapa_cerrar     abre el fichero y valida la cabecera
+    mapa_tesela                  proyecta solo las filas de una tesela y
+                                 devuelve un puntero a su primer elemento y la
+                                 distancia entre filas; mapa_filas y
+                                 mapa_columna son casos particulares
+    mapa_suma                    recalcula la suma de control
+    mapa_comparar                diferencias entre dos ficheros (dos ejecuciones)
+
+  Los recorridos completos van por ventanas de unos MAPA_VENTANA bytes: se
+  proyecta una ventana, se avisa al sistema de que se va a leer entera y en
+  orden (madvise con MADV_SEQUENTIAL y MADV_WILLNEED, que adelantan la
+  lectura) y se desproyecta al terminar. Asi la memoria ocupada no depende
+  del tamano del fichero. En Windows no hay equivalente directo de madvise y
+  los consejos se ignoran.
+
+  No usa MPI: lo llama un solo proceso.
+================================================================================
+*/
+
+#ifndef MAPA_MATRIZ_H
+#define MAPA_MATRIZ_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "matriz_binaria.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MAPA_VENTANA ((int64_t)64 << 20)
+
+// Consejos de acceso para una proyeccion
+#define MAPA_NORMAL 0
+#define MAPA_SECUENCIAL 1
+#define MAPA_ALEATORIO 2
+
+typedef struct {
+#ifdef _WIN32
+    HANDLE fichero;
+    HANDLE proyeccion;
+#else
+    int descriptor;
+#endif
+    int64_t tamano;             // Bytes del fichero
+    int64_t granularidad;       // Alineacion exigida al desplazamiento de una proyeccion
+    CabeceraMatriz cabecera;
+} MatrizMapeada;
+
+// Trozo proyectado: 'datos' apunta al primer elemento pedido y las filas estan a 'ld' elementos
+typedef struct {
+    void* base;
+    size_t longitud;
+    const void* datos;
+    int64_t ld;
+    int fila0, col0;
+    int filas, columnas;
+} VistaMatriz;
+
+typedef struct {
+    long long distintos;        // Elementos con |a - b| > tolerancia
+    double maxima;              // Mayor |a - b|
+    long long fila, columna;    // Primera diferencia (-1 si no hay)
+} DiferenciaMatrices;
+
+// Proyecta 'longitud' bytes del fichero desde 'desplazamiento' (ya alineado)
+inline void* mapa_proyectar(const MatrizMapeada* m, int64_t desplazamiento, size_t longitud, int consejo)
+{
+#ifdef _WIN32
+    (void)consejo;
+    return MapViewOfFile(m->proyeccion, FILE_MAP_READ, (DWORD)((uint64_t)desplazamiento >> 32),
+        (DWORD)(desplazamiento & 0xFFFFFFFF), longitud);
+#else
+    void* base = mmap(NULL, longitud, PROT_READ, MAP_PRIVATE, m->descriptor, (off_t)desplazamiento);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    if (consejo == MAPA_SECUENCIAL) {
+        madvise(base, longitud, MADV_SEQUENTIAL);
+        madvise(base, longitud, MADV_WILLNEED);
+    }
+    else if (consejo == MAPA_ALEATORIO) {
+        madvise(base, longitud, MADV_RANDOM);
+    }
+    return base;
+#endif
+}
+
+inline void mapa_desproyectar(void* base, size_t longitud)
+{
+#ifdef _WIN32
+    (void)longitud;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, longitud);
+#endif
+}
+
+// Abre el fichero y valida su cabecera y su tamano; devuelve un codigo MATRIZ_*
+inline int mapa_abrir(MatrizMapeada* m, const char* nombre)
+{
+    memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+    m->fichero = CreateFileA(nombre, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER tamano;
+    if (m->fichero == INVALID_HANDLE_VALUE || !GetFileSizeEx(m->fichero, &tamano)) {
+        return MATRIZ_ERROR_ES;
+    }
+    m->tamano = tamano.QuadPart;
+    m->proyeccion = m->tamano > 0 ? CreateFileMappingA(m->fichero, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    if (m->proyeccion == NULL) {
+        CloseHandle(m->fichero);
+        return m->tamano > 0 ? MATRIZ_ERROR_ES : MATRIZ_ERROR_FORMATO;
+    }
+    SYSTEM_INFO sistema;
+    GetSystemInfo(&sistema);
+    m->granularidad = sistema.dwAllocationGranularity;
+#else
+    struct stat datos;
+    m->descriptor = open(nombre, O_RDONLY);
+    if (m->descriptor < 0 || fstat(m->descriptor, &datos) != 0) {
+        return MATRIZ_ERROR_ES;
+    }
+    m->tamano = datos.st_size;
+    m->granularidad = sysconf(_SC_PAGESIZE);
+#endif
+    int codigo = MATRIZ_ERROR_FORMATO;
+    if (m->tamano >= MATRIZ_DATOS) {
+        void* base = mapa_proyectar(m, 0, MATRIZ_DATOS, MAPA_NORMAL);
+        if (base == NULL) {
+            codigo = MATRIZ_ERROR_ES;
+        }
+        else {
+            memcpy(&m->cabecera, base, sizeof(m->cabecera));
+            mapa_desproyectar(base, MATRIZ_DATOS);
+            const CabeceraMatriz* c = &m->cabecera;
+            if (matriz_cabecera_valida(c) && m->tamano >= MATRIZ_DATOS + c->metadatos
+                + c->filas * c->columnas * (int64_t)matriz_tamano_elemento(c->tipo)) {
+                codigo = MATRIZ_OK;
+            }
+        }
+    }
+    if (codigo != MATRIZ_OK) {
+#ifdef _WIN32
+        CloseHandle(m->proyeccion);
+        CloseHandle(m->fichero);
+#else
+        close(m->descriptor);
+#endif
+    }
+    return codigo;
+}
+
+inline void mapa_cerrar(MatrizMapeada* m)
+{
+#ifdef _WIN32
+    CloseHandle(m->proyeccion);
+    CloseHandle(m->fichero);
+#else
+    close(m->descriptor);
+#endif
+}
+
+/*
+   Proyecta las filas [fila0, fila0 + filas) y deja en 'v' la tesela que
+   empieza en la columna col0 con 'columnas' columnas. Solo se proyectan las
+   filas que ocupa (las columnas de fuera se leen del disco solo si comparten
+   pagina). Devuelve 0 si la tesela se sale de la matriz o falla la proyeccion.
+*/
+inline int mapa_tesela(const MatrizMapeada* m, int fila0, int col0, int filas, int columnas,
+    int consejo, VistaMatriz* v)
+{
+    const CabeceraMatriz* c = &m->cabecera;
+    memset(v, 0, sizeof(*v));
+    if (fila0 < 0 || col0 < 0 || filas <= 0 || columnas <= 0
+        || fila0 + (int64_t)filas > c->filas || col0 + (int64_t)columnas > c->columnas) {
+        return 0;
+    }
+    int64_t tamano = (int64_t)matriz_tamano_elemento(c->tipo);
+    int64_t inicio = MATRIZ_DATOS + ((int64_t)fila0 * c->columnas + col0) * tamano;
+    int64_t fin = MATRIZ_DATOS + ((int64_t)(fila0 + filas - 1) * c->columnas + col0 + columnas) * tamano;
+    int64_t alineado = inicio / m->granularidad * m->granularidad;
+    v->longitud = (size_t)(fin - alineado);
+    v->base = mapa_proyectar(m, alineado, v->longitud, consejo);
+    if (v->base == NULL) {
+        return 0;
+    }
+    v->datos = (const char*)v->base + (inicio - alineado);
+    v->ld = c->columnas;
+    v->fila0 = fila0;
+    v->col0 = col0;
+    v->filas = filas;
+    v->columnas = columnas;
+    return 1;
+}
+
+inline int mapa_filas(const MatrizMapeada* m, int fila0, int filas, int consejo, VistaMatriz* v)
+{
+    return mapa_tesela(m, fila0, 0, filas, (int)m->cabecera.columnas, consejo, v);
+}
+
+// Una columna entera: toca una pagina por fila, asi que se pide acceso aleatorio
+inline int mapa_columna(const MatrizMapeada* m, int columna, VistaMatriz* v)
+{
+    return mapa_tesela(m, 0, columna, (int)m->cabecera.filas, 1, MAPA_ALEATORIO, v);
+}
+
+inline void mapa_liberar_vista(VistaMatriz* v)
+{
+    if (v->base != NULL) {
+        mapa_desproyectar(v->base, v->longitud);
+        v->base = NULL;
+    }
+}
+
+// Elemento (i, j) de la vista, relativo a su esquina, convertido a double
+inline double mapa_valor(const VistaMatriz* v, int tipo, int i, int j)
+{
+    size_t indice = (size_t)i * v->ld + j;
+    return tipo == MATRIZ_REAL ? ((const double*)v->datos)[indice] : (double)((const int32_t*)v->datos)[indice];
+}
+
+// Filas por ventana para recorrer la matriz completa en trozos de unos MAPA_VENTANA bytes
+inline int mapa_filas_ventana(const MatrizMapeada* m)
+{
+    int64_t bytes_fila = m->cabecera.columnas * (int64_t)matriz_tamano_elemento(m->cabecera.tipo);
+    int64_t filas = MAPA_VENTANA / bytes_fila;
+    return filas > 0 ? (int)filas : 1;
+}
+
+// Recalcula la suma de control recorriendo el fichero por ventanas; 0 en *correcto si falla la proyeccion
+inline uint64_t mapa_suma(const MatrizMapeada* m, int* correcto)
+{
+    const CabeceraMatriz* c = &m->cabecera;
+    int ventana = mapa_filas_ventana(m);
+    uint64_t suma = 0;
+    *correcto = 1;
+    for (int fila0 = 0; fila0 < c->filas; fila0 += ventana) {
+        int filas = (int)(c->filas - fila0 < ventana ? c->filas - fila0 : ventana);
+        VistaMatriz v;
+        if (!mapa_filas(m, fila0, filas, MAPA_SECUENCIAL, &v)) {
+            *correcto = 0;
+            return 0;
+        }
+        suma += matriz_suma_tesela(v.datos, c->tipo, c->columnas,
+            matriz_tesela(fila0, 0, filas, (int)c->columnas, (int)c->columnas));
+        mapa_liberar_vista(&v);
+    }
+    return suma;
+}
+
+/*
+   Compara dos matrices de la misma forma recorriendo ambas por ventanas.
+   Cuenta los elementos que difieren en mas de 'tolerancia' (0: igualdad
+   exacta) y devuelve la mayor diferencia y la primera posicion distinta.
+   Devuelve 0 si las formas no coinciden o falla una proyeccion.
+*/
+inline int mapa_comparar(const MatrizMapeada* a, const MatrizMapeada* b, double tolerancia,
+    DiferenciaMatrices* d)
+{
+    const CabeceraMatriz* c = &a->cabecera;
+    d->distintos = 0;
+    d->maxima = 0.0;
+    d->fila = d->columna = -1;
+    if (c->filas != b->cabecera.filas || c->columnas != b->cabecera.columnas) {
+        return 0;
+    }
+    int ventana = mapa_filas_ventana(a) < mapa_filas_ventana(b) ? mapa_filas_ventana(a) : mapa_filas_ventana(b);
+    int columnas = (int)c->columnas;
+    for (int fila0 = 0; fila0 < c->filas; fila0 += ventana) {
+        int filas = (int)(c->filas - fila0 < ventana ? c->filas - fila0 : ventana);
+        VistaMatriz va, vb;
+        if (!mapa_filas(a, fila0, filas, MAPA_SECUENCIAL, &va)) {
+            return 0;
+        }
+        if (!mapa_filas(b, fila0, filas, MAPA_SECUENCIAL, &vb)) {
+            mapa_liberar_vista(&va);
+            return 0;
+        }
+        for (int i = 0; i < filas; i++) {
+            for (int j = 0; j < columnas; j++) {
+                double diferencia = fabs(mapa_valor(&va, c->tipo, i, j) - mapa_valor(&vb, b->cabecera.tipo, i, j));
+                // La comparacion negada cuenta tambien los NaN como distintos
+                if (!(diferencia <= tolerancia)) {
+                    if (d->distintos == 0) {
+                        d->fila = fila0 + i;
+                        d->columna = j;
+                    }
+                    d->distintos++;
+                }
+                if (diferencia > d->maxima) {
+                    d->maxima = diferencia;
+                }
+            }
+        }
+        mapa_liberar_vista(&va);
+        mapa_liberar_vista(&vb);
+    }
+    return 1;
+}
+
+#endif
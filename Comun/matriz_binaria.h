@@ -0,0 +1,383 @@
+/*
+================================================================================
+  FORMATO BINARIO PARA MATRICES DISTRIBUIDAS
+  Arquitectura Paralela con MPI - codigo comun a las practicas
+================================================================================
+
+  Un fichero .mat tiene una cabecera fija de MATRIZ_DATOS (64) bytes y a
+  continuacion los elementos de la matriz global por filas, en binario nativo:
+
+    bytes  0- 7  magia "MPIMATR1"
+    bytes  8-11  version (1)
+    bytes 12-15  0x01020304, para detectar un fichero de otra arquitectura
+    bytes 16-19  tipo de elemento: MATRIZ_ENTERO (int de 32 bits) o MATRIZ_REAL (double)
+    bytes 20-23  reparto con el que se escribio: completa, bloques de filas o teselas
+    bytes 24-39  filas y columnas (64 bits)
+    bytes 40-47  malla de procesos que la escribio (filas x columnas)
+    bytes 48-55  suma de control
+    bytes 56-63  bytes de metadatos de la aplicacion que siguen a la matriz (0 si no hay)
+
+  Los metadatos (por ejemplo el estado de un punto de control) van al final
+  del fichero, tras el ultimo elemento; su formato es cosa de la aplicacion.
+
+  El reparto y la malla son solo informativos: los datos estan siempre en su
+  posicion global, asi que se pueden leer con cualquier numero de procesos y
+  cualquier reparto.
+
+  Cada proceso escribe o lee su tesela directamente en su sitio del fichero.
+  Para ello fija una vista cuyo tipo de fichero es un MPI_Type_create_subarray
+  de la matriz global, y usa MPI_File_iwrite_all / MPI_File_read_all. La
+  tesela puede estar en memoria con una distancia entre filas mayor que su
+  anchura (por ejemplo con relleno o bordes), y se describe con un
+  MPI_Type_vector. La escritura se puede dejar en curso
+  (matriz_escribir_iniciar / matriz_escribir_terminar) para seguir
+  calculando mientras se guarda.
+
+  La suma de control es la de las practicas: el patron de bits de cada
+  elemento por su posicion global (por filas, desde 1) modulo 2^64. Al ser
+  una suma, cada proceso calcula la de su tesela y se combinan con MPI_SUM;
+  detecta tanto valores erroneos como bloques fuera de su sitio.
+================================================================================
+*/
+
+#ifndef MATRIZ_BINARIA_H
+#define MATRIZ_BINARIA_H
+
+#include <mpi.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MATRIZ_MAGIA "MPIMATR1"
+#define MATRIZ_VERSION 1
+#define MATRIZ_ORDEN 0x01020304
+#define MATRIZ_DATOS 64             // Posicion del primer elemento en el fichero
+
+// Tipo de elemento
+#define MATRIZ_ENTERO 1
+#define MATRIZ_REAL 2
+
+// Reparto con el que se escribio
+#define MATRIZ_COMPLETA 0
+#define MATRIZ_FILAS 1
+#define MATRIZ_TESELAS 2
+
+// Resultados de escritura y lectura (iguales en todos los procesos)
+#define MATRIZ_OK 0
+#define MATRIZ_ERROR_ES 1
+#define MATRIZ_ERROR_FORMATO 2
+#define MATRIZ_ERROR_SUMA 3
+
+typedef struct {
+    char magia[8];
+    int32_t version;
+    int32_t orden;
+    int32_t tipo;
+    int32_t reparto;
+    int64_t filas;
+    int64_t columnas;
+    int32_t malla[2];
+    uint64_t suma;
+    int64_t metadatos;
+} CabeceraMatriz;
+
+static_assert(sizeof(CabeceraMatriz) == MATRIZ_DATOS, "La cabecera debe ocupar MATRIZ_DATOS bytes");
+
+// Tesela de un proceso: esquina global, tamano y distancia entre filas en memoria
+typedef struct {
+    int fila0, col0;
+    int filas, columnas;
+    int ld;
+} TeselaMatriz;
+
+inline TeselaMatriz matriz_tesela(int fila0, int col0, int filas, int columnas, int ld)
+{
+    TeselaMatriz t = { fila0, col0, filas, columnas, ld };
+    return t;
+}
+
+inline MPI_Datatype matriz_tipo_mpi(int tipo)
+{
+    return tipo == MATRIZ_REAL ? MPI_DOUBLE : MPI_INT;
+}
+
+inline size_t matriz_tamano_elemento(int tipo)
+{
+    return tipo == MATRIZ_REAL ? sizeof(double) : sizeof(int32_t);
+}
+
+inline const char* matriz_mensaje(int codigo)
+{
+    switch (codigo) {
+    case MATRIZ_OK: return "correcto";
+    case MATRIZ_ERROR_ES: return "error de entrada/salida";
+    case MATRIZ_ERROR_FORMATO: return "no es un fichero de matriz valido";
+    default: return "la suma de control no coincide";
+    }
+}
+
+// Parte de la suma de control que corresponde a una tesela
+inline uint64_t matriz_suma_tesela(const void* datos, int tipo, int64_t columnas_globales, TeselaMatriz t)
+{
+    uint64_t suma = 0;
+    for (int i = 0; i < t.filas; i++) {
+        uint64_t posicion = (uint64_t)(t.fila0 + i) * columnas_globales + t.col0 + 1;
+        for (int j = 0; j < t.columnas; j++) {
+            size_t indice = (size_t)i * t.ld + j;
+            uint64_t bits;
+            if (tipo == MATRIZ_REAL) {
+                memcpy(&bits, (const double*)datos + indice, sizeof(bits));
+            }
+            else {
+                bits = (uint32_t)((const int32_t*)datos)[indice];
+            }
+            suma += bits * (posicion + j);
+        }
+    }
+    return suma;
+}
+
+/*
+   Tipos de la tesela: en el fichero, un subarray de la matriz global; en
+   memoria, 'filas' filas de 'columnas' elementos separadas 'ld'. Devuelve
+   cuantos tipo_memoria hay que transferir (0 si la tesela esta vacia; en ese
+   caso ambos tipos son el del elemento y no hay que liberarlos).
+*/
+inline int matriz_tipos_tesela(int tipo, int64_t filas, int64_t columnas, TeselaMatriz t,
+    MPI_Datatype* tipo_fichero, MPI_Datatype* tipo_memoria)
+{
+    MPI_Datatype elemento = matriz_tipo_mpi(tipo);
+    if (t.filas <= 0 || t.columnas <= 0) {
+        *tipo_fichero = elemento;
+        *tipo_memoria = elemento;
+        return 0;
+    }
+    int tamanos[2] = { (int)filas, (int)columnas };
+    int subtamanos[2] = { t.filas, t.columnas };
+    int inicios[2] = { t.fila0, t.col0 };
+    MPI_Type_create_subarray(2, tamanos, subtamanos, inicios, MPI_ORDER_C, elemento, tipo_fichero);
+    MPI_Type_commit(tipo_fichero);
+    MPI_Type_vector(t.filas, t.columnas, t.ld, elemento, tipo_memoria);
+    MPI_Type_commit(tipo_memoria);
+    return 1;
+}
+
+inline void matriz_liberar_tipos(int cantidad, MPI_Datatype* tipo_fichero, MPI_Datatype* tipo_memoria)
+{
+    if (cantidad > 0) {
+        MPI_Type_free(tipo_fichero);
+        MPI_Type_free(tipo_memoria);
+    }
+}
+
+// Escritura en curso: se lanza con matriz_escribir_iniciar y se completa con matriz_escribir_terminar
+typedef struct {
+    MPI_Comm comm;
+    MPI_File fh;
+    MPI_Request peticion;
+    MPI_Datatype tipo_fichero, tipo_memoria;
+    int cantidad;
+    int error;
+} EscrituraMatriz;
+
+/*
+   Operacion colectiva en 'comm': cada proceso aporta su tesela (que puede
+   estar vacia) de una matriz filas x columnas y el fichero queda con la
+   cabecera, la matriz completa y 'bytes_metadatos' bytes de la raiz al
+   final. Las teselas deben cubrir la matriz sin solaparse. La cabecera y los
+   metadatos se escriben ya; los datos con MPI_File_iwrite_all, asi que la
+   tesela no se puede modificar hasta matriz_escribir_terminar. Si 'suma' no
+   es NULL, la raiz recibe la suma de control.
+*/
+inline void matriz_escribir_iniciar(MPI_Comm comm, const char* nombre, MPI_Info pistas, int tipo,
+    int64_t filas, int64_t columnas, int reparto, const int malla[2], const void* datos, TeselaMatriz t,
+    const void* metadatos, int bytes_metadatos, EscrituraMatriz* e, uint64_t* suma)
+{
+    int mirango;
+    MPI_Comm_rank(comm, &mirango);
+
+    CabeceraMatriz c;
+    memset(&c, 0, sizeof(c));
+    memcpy(c.magia, MATRIZ_MAGIA, sizeof(c.magia));
+    c.version = MATRIZ_VERSION;
+    c.orden = MATRIZ_ORDEN;
+    c.tipo = tipo;
+    c.reparto = reparto;
+    c.filas = filas;
+    c.columnas = columnas;
+    c.malla[0] = malla[0];
+    c.malla[1] = malla[1];
+    c.metadatos = bytes_metadatos;
+    unsigned long long parcial = matriz_suma_tesela(datos, tipo, columnas, t), total = 0;
+    MPI_Reduce(&parcial, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, comm);
+    c.suma = total;
+    if (suma != NULL) {
+        *suma = total;
+    }
+
+    e->comm = comm;
+    e->peticion = MPI_REQUEST_NULL;
+    e->cantidad = 0;
+    e->error = 0;
+    if (MPI_File_open(comm, nombre, MPI_MODE_CREATE | MPI_MODE_WRONLY, pistas, &e->fh) != MPI_SUCCESS) {
+        e->fh = MPI_FILE_NULL;
+        e->error = 1;
+        return;
+    }
+    // Recortar por si quedaba un fichero mas largo de otra ejecucion
+    int64_t bytes_datos = filas * columnas * (int64_t)matriz_tamano_elemento(tipo);
+    e->error |= MPI_File_set_size(e->fh, MATRIZ_DATOS + bytes_datos + bytes_metadatos) != MPI_SUCCESS;
+    if (mirango == 0) {
+        e->error |= MPI_File_write_at(e->fh, 0, &c, (int)sizeof(c), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+        if (bytes_metadatos > 0) {
+            e->error |= MPI_File_write_at(e->fh, MATRIZ_DATOS + bytes_datos, (void*)metadatos, bytes_metadatos,
+                MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+        }
+    }
+    e->cantidad = matriz_tipos_tesela(tipo, filas, columnas, t, &e->tipo_fichero, &e->tipo_memoria);
+    e->error |= MPI_File_set_view(e->fh, MATRIZ_DATOS, matriz_tipo_mpi(tipo), e->tipo_fichero,
+        (char*)"native", pistas) != MPI_SUCCESS;
+    e->error |= MPI_File_iwrite_all(e->fh, (void*)datos, e->cantidad, e->tipo_memoria, &e->peticion)
+        != MPI_SUCCESS;
+}
+
+// Da ocasion a la implementacion de avanzar la escritura pendiente (no bloquea)
+inline void matriz_escribir_avanzar(EscrituraMatriz* e)
+{
+    int completada;
+    MPI_Test(&e->peticion, &completada, MPI_STATUS_IGNORE);
+}
+
+// Operacion colectiva: espera a que termine la escritura y cierra el fichero
+inline int matriz_escribir_terminar(EscrituraMatriz* e)
+{
+    if (e->fh != MPI_FILE_NULL) {
+        e->error |= MPI_Wait(&e->peticion, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+        MPI_File_close(&e->fh);
+        matriz_liberar_tipos(e->cantidad, &e->tipo_fichero, &e->tipo_memoria);
+    }
+    int algun_error;
+    MPI_Allreduce(&e->error, &algun_error, 1, MPI_INT, MPI_MAX, e->comm);
+    return algun_error ? MATRIZ_ERROR_ES : MATRIZ_OK;
+}
+
+// Escritura bloqueante y sin metadatos: matriz_escribir_iniciar + matriz_escribir_terminar
+inline int matriz_escribir(MPI_Comm comm, const char* nombre, MPI_Info pistas, int tipo,
+    int64_t filas, int64_t columnas, int reparto, const int malla[2],
+    const void* datos, TeselaMatriz t, uint64_t* suma)
+{
+    EscrituraMatriz e;
+    matriz_escribir_iniciar(comm, nombre, pistas, tipo, filas, columnas, reparto, malla, datos, t,
+        NULL, 0, &e, suma);
+    return matriz_escribir_terminar(&e);
+}
+
+// Comprueba la magia, la version, el orden de bytes y que las dimensiones tengan sentido
+inline int matriz_cabecera_valida(const CabeceraMatriz* c)
+{
+    return memcmp(c->magia, MATRIZ_MAGIA, sizeof(c->magia)) == 0
+        && c->version == MATRIZ_VERSION && c->orden == MATRIZ_ORDEN
+        && (c->tipo == MATRIZ_ENTERO || c->tipo == MATRIZ_REAL)
+        && c->filas > 0 && c->columnas > 0 && c->filas <= INT32_MAX && c->columnas <= INT32_MAX
+        && c->metadatos >= 0;
+}
+
+// Operacion colectiva en 'comm': la raiz lee y valida la cabecera y la difunde
+inline int matriz_leer_cabecera(MPI_Comm comm, const char* nombre, CabeceraMatriz* c)
+{
+    int mirango, codigo = MATRIZ_OK;
+    MPI_Comm_rank(comm, &mirango);
+    memset(c, 0, sizeof(*c));
+    if (mirango == 0) {
+        MPI_File fh;
+        MPI_Status estado;
+        int leidos = 0;
+        if (MPI_File_open(MPI_COMM_SELF, nombre, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+            codigo = MATRIZ_ERROR_ES;
+        }
+        else {
+            if (MPI_File_read_at(fh, 0, c, (int)sizeof(*c), MPI_BYTE, &estado) == MPI_SUCCESS) {
+                MPI_Get_count(&estado, MPI_BYTE, &leidos);
+            }
+            MPI_File_close(&fh);
+            if (leidos != (int)sizeof(*c) || !matriz_cabecera_valida(c)) {
+                codigo = MATRIZ_ERROR_FORMATO;
+            }
+        }
+    }
+    MPI_Bcast(&codigo, 1, MPI_INT, 0, comm);
+    MPI_Bcast(c, (int)sizeof(*c), MPI_BYTE, 0, comm);
+    return codigo;
+}
+
+/*
+   Operacion colectiva en 'comm': la raiz lee los metadatos de la aplicacion
+   y los difunde. Falla con MATRIZ_ERROR_FORMATO si no ocupan 'bytes' bytes.
+*/
+inline int matriz_leer_metadatos(MPI_Comm comm, const char* nombre, const CabeceraMatriz* c,
+    void* destino, int bytes)
+{
+    int mirango, codigo = MATRIZ_OK;
+    MPI_Comm_rank(comm, &mirango);
+    if (c->metadatos != bytes) {
+        return MATRIZ_ERROR_FORMATO;
+    }
+    if (mirango == 0) {
+        MPI_File fh;
+        MPI_Status estado;
+        int leidos = 0;
+        MPI_Offset posicion = MATRIZ_DATOS + c->filas * c->columnas * (int64_t)matriz_tamano_elemento(c->tipo);
+        if (MPI_File_open(MPI_COMM_SELF, nombre, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+            codigo = MATRIZ_ERROR_ES;
+        }
+        else {
+            if (MPI_File_read_at(fh, posicion, destino, bytes, MPI_BYTE, &estado) == MPI_SUCCESS) {
+                MPI_Get_count(&estado, MPI_BYTE, &leidos);
+            }
+            MPI_File_close(&fh);
+            if (leidos != bytes) {
+                codigo = MATRIZ_ERROR_FORMATO;
+            }
+        }
+    }
+    MPI_Bcast(&codigo, 1, MPI_INT, 0, comm);
+    MPI_Bcast(destino, bytes, MPI_BYTE, 0, comm);
+    return codigo;
+}
+
+/*
+   Operacion colectiva en 'comm': cada proceso lee la tesela que quiera de una
+   matriz cuya cabecera ya se ha leido, con independencia del reparto con el
+   que se escribio. Con 'comprobar' se verifica la suma de control, para lo
+   que las teselas deben cubrir la matriz sin solaparse.
+*/
+inline int matriz_leer(MPI_Comm comm, const char* nombre, MPI_Info pistas, const CabeceraMatriz* c,
+    void* datos, TeselaMatriz t, int comprobar)
+{
+    MPI_File fh;
+    if (MPI_File_open(comm, nombre, MPI_MODE_RDONLY, pistas, &fh) != MPI_SUCCESS) {
+        return MATRIZ_ERROR_ES;
+    }
+    MPI_Datatype tipo_fichero, tipo_memoria;
+    int cantidad = matriz_tipos_tesela(c->tipo, c->filas, c->columnas, t, &tipo_fichero, &tipo_memoria);
+    int error = MPI_File_set_view(fh, MATRIZ_DATOS, matriz_tipo_mpi(c->tipo), tipo_fichero,
+        (char*)"native", pistas) != MPI_SUCCESS;
+    error |= MPI_File_read_all(fh, datos, cantidad, tipo_memoria, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+    MPI_File_close(&fh);
+    matriz_liberar_tipos(cantidad, &tipo_fichero, &tipo_memoria);
+
+    int algun_error;
+    MPI_Allreduce(&error, &algun_error, 1, MPI_INT, MPI_MAX, comm);
+    if (algun_error) {
+        return MATRIZ_ERROR_ES;
+    }
+    if (comprobar) {
+        unsigned long long parcial = matriz_suma_tesela(datos, c->tipo, c->columnas, t), total;
+        MPI_Allreduce(&parcial, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+        if (total != c->suma) {
+            return MATRIZ_ERROR_SUMA;
+        }
+    }
+    return MATRIZ_OK;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+================================================================================
+  PISTAS (MPI_Info) PARA LA ENTRADA/SALIDA PARALELA
+  Arquitectura Paralela con MPI - codigo comun a las practicas
+================================================================================
+
+  MPI_File_open acepta un objeto MPI_Info con pistas para la implementacion.
+  Con ROMIO las que mas influyen en la escritura sobre un fichero compartido
+  son las del collective buffering (cuantos procesos agregadores escriben y
+  con que buffer) y las de reparto del fichero en el sistema de ficheros:
+    cb_buffer_size   tamano del buffer de cada agregador (bytes)
+    cb_nodes         numero de agregadores
+    romio_cb_write   enable | disable | automatic
+    romio_cb_read    enable | disable | automatic
+    romio_ds_read    data sieving en lectura: enable | disable | automatic
+    romio_ds_write   data sieving en escritura
+    striping_factor  numero de servidores (OST en Lustre) al crear el fichero
+    striping_unit    tamano de cada franja (bytes)
+
+  Las pistas se leen en la raiz de:
+    1. El fichero indicado en MPI_PISTAS_FICHERO, una pista por linea con el
+       formato "clave = valor" o "clave valor"; '#' inicia un comentario
+    2. La variable MPI_PISTAS, con pares "clave=valor" separados por ';'.
+       Tiene prioridad sobre el fichero
+  y se difunden para que todos los procesos abran con las mismas pistas. Las
+  claves no se filtran: se pasa cualquier pista que entienda la implementacion,
+  y las que no entienda se ignoran. Para ver los valores que se han aplicado
+  de verdad hay que preguntar al fichero ya abierto (pistas_imprimir).
+================================================================================
+*/
+
+#ifndef PISTAS_ES_H
+#define PISTAS_ES_H
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PISTAS_MAX_TEXTO 8192
+
+// Copia en 'destino' el valor de la variable de entorno (cadena vacia si no esta)
+inline void pistas_entorno(const char* nombre, char* destino, size_t capacidad)
+{
+    destino[0] = '\0';
+#ifdef _MSC_VER
+    char* valor = NULL;
+    size_t longitud;
+    if (_dupenv_s(&valor, &longitud, nombre) == 0 && valor != NULL) {
+        strncpy_s(destino, capacidad, valor, _TRUNCATE);
+        free(valor);
+    }
+#else
+    const char* valor = getenv(nombre);
+    if (valor != NULL) {
+        strncpy(destino, valor, capacidad - 1);
+        destino[capacidad - 1] = '\0';
+    }
+#endif
+}
+
+// Anade a 'info' las pistas de 'texto' (una por linea); modifica el texto
+inline void pistas_aplicar(MPI_Info info, char* texto)
+{
+    char* linea = texto;
+    while (*linea != '\0') {
+        char* siguiente = strchr(linea, '\n');
+        if (siguiente != NULL) {
+            *siguiente++ = '\0';
+        }
+        else {
+            siguiente = linea + strlen(linea);
+        }
+        char* comentario = strchr(linea, '#');
+        if (comentario != NULL) *comentario = '\0';
+
+        // "clave = valor" o "clave valor", sin espacios alrededor
+        char* p = linea;
+        while (*p == ' ' || *p == '\t') p++;
+        char* clave = p;
+        while (*p != '\0' && *p != '=' && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        char* fin_clave = p;
+        while (*p == ' ' || *p == '\t' || *p == '=') p++;
+        char* valor = p;
+        char* fin_valor = valor + strlen(valor);
+        while (fin_valor > valor && (fin_valor[-1] == ' ' || fin_valor[-1] == '\t' || fin_valor[-1] == '\r')) {
+            fin_valor--;
+        }
+        *fin_valor = '\0';
+        *fin_clave = '\0';
+        if (*clave != '\0' && *valor != '\0') {
+            MPI_Info_set(info, clave, valor);
+        }
+        linea = siguiente;
+    }
+}
+
+/*
+   Operacion colectiva en 'comm': devuelve un MPI_Info (que libera el llamador
+   con MPI_Info_free) con las pistas configuradas; puede estar vacio.
+*/
+inline MPI_Info pistas_cargar(MPI_Comm comm)
+{
+    int mirango;
+    MPI_Comm_rank(comm, &mirango);
+    char texto[PISTAS_MAX_TEXTO];
+    texto[0] = '\0';
+    if (mirango == 0) {
+        char ruta[1024];
+        pistas_entorno("MPI_PISTAS_FICHERO", ruta, sizeof(ruta));
+        if (ruta[0] != '\0') {
+            FILE* f = NULL;
+#ifdef _MSC_VER
+            fopen_s(&f, ruta, "r");
+#else
+            f = fopen(ruta, "r");
+#endif
+            if (f != NULL) {
+                size_t leidos = fread(texto, 1, sizeof(texto) - 2, f);
+                texto[leidos] = '\0';
+                fclose(f);
+            }
+            else {
+                fprintf(stderr, "AVISO: No se pudo leer el fichero de pistas '%s'.\n", ruta);
+            }
+        }
+        // Las pistas del entorno van detras para que sobrescriban a las del fichero
+        size_t longitud = strlen(texto);
+        texto[longitud++] = '\n';
+        pistas_entorno("MPI_PISTAS", texto + longitud, sizeof(texto) - longitud);
+        for (char* c = texto + longitud; *c != '\0'; c++) {
+            if (*c == ';') *c = '\n';
+        }
+    }
+    MPI_Bcast(texto, sizeof(texto), MPI_CHAR, 0, comm);
+
+    MPI_Info info;
+    MPI_Info_create(&info);
+    pistas_aplicar(info, texto);
+    return info;
+}
+
+// Numero de pistas configuradas en 'info'
+inline int pistas_numero(MPI_Info info)
+{
+    int claves = 0;
+    MPI_Info_get_nkeys(info, &claves);
+    return claves;
+}
+
+// Escribe en 'f' las pistas efectivas del fichero abierto, una por linea
+inline void pistas_imprimir(MPI_File fh, FILE* f, const char* prefijo)
+{
+    MPI_Info info;
+    MPI_File_get_info(fh, &info);
+    int claves = pistas_numero(info);
+    for (int i = 0; i < claves; i++) {
+        char clave[MPI_MAX_INFO_KEY + 1], valor[MPI_MAX_INFO_VAL + 1];
+        int definida;
+        MPI_Info_get_nthkey(info, i, clave);
+        MPI_Info_get(info, clave, MPI_MAX_INFO_VAL, valor, &definida);
+        fprintf(f, "%s%s = %s\n", prefijo, clave, definida ? valor : "");
+    }
+    fflush(f);
+    MPI_Info_free(&info);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+================================================================================
+  SALIDA ORDENADA POR RANGO
+  Arquitectura Paralela con MPI - codigo comun a las practicas
+================================================================================
+
+  Sustituye al bucle "for (i = 0; i < numprocs; i++) { if (mirango == i)
+  printf(...); MPI_Barrier(...); }", que cuesta una barrera por proceso.
+  Cada proceso acumula sus lineas en un buffer local y salida_volcar() las
+  reune en la raiz con un MPI_Gather de longitudes y un MPI_Gatherv del texto.
+  La raiz las escribe en orden de rango con un unico fwrite.
+
+  Cada linea lleva un nivel de detalle:
+    0 - resumen: solo lo que imprime la raiz por su cuenta. No se acumula nada
+        y salida_volcar() no hace ninguna comunicacion
+    1 - procesos: una linea por proceso
+    2 - elementos: lineas por elemento (valores individuales, vectores...)
+  El nivel se lee de la variable de entorno MPI_VERBOSIDAD (0, 1 o 2). Si no
+  esta definida se usa el que indique el programa, y la raiz lo difunde
+  para que todos los procesos tomen la misma decision.
+================================================================================
+*/
+
+#ifndef SALIDA_H
+#define SALIDA_H
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#define SALIDA_RESUMEN 0
+#define SALIDA_PROCESOS 1
+#define SALIDA_ELEMENTOS 2
+
+typedef struct {
+    MPI_Comm comm;
+    int nivel;           // Nivel de detalle en uso (igual en todos los procesos)
+    char* texto;         // Lineas acumuladas pendientes de volcar
+    size_t longitud;
+    size_t capacidad;
+} SalidaOrdenada;
+
+// Nivel pedido en MPI_VERBOSIDAD, o 'por_defecto' si no esta definida
+inline int salida_nivel_entorno(int por_defecto)
+{
+    int nivel = por_defecto;
+#ifdef _MSC_VER
+    char* valor = NULL;
+    size_t longitud;
+    if (_dupenv_s(&valor, &longitud, "MPI_VERBOSIDAD") == 0 && valor != NULL) {
+        nivel = atoi(valor);
+        free(valor);
+    }
+#else
+    const char* valor = getenv("MPI_VERBOSIDAD");
+    if (valor != NULL) {
+        nivel = atoi(valor);
+    }
+#endif
+    if (nivel < SALIDA_RESUMEN) nivel = SALIDA_RESUMEN;
+    if (nivel > SALIDA_ELEMENTOS) nivel = SALIDA_ELEMENTOS;
+    return nivel;
+}
+
+// Operacion colectiva en 'comm': fija el nivel con el que decide la raiz (rango 0)
+inline void salida_iniciar(SalidaOrdenada* s, MPI_Comm comm, int nivel_por_defecto)
+{
+    s->comm = comm;
+    s->nivel = salida_nivel_entorno(nivel_por_defecto);
+    MPI_Bcast(&s->nivel, 1, MPI_INT, 0, comm);
+    s->texto = NULL;
+    s->longitud = 0;
+    s->capacidad = 0;
+}
+
+// Indica si las lineas de ese nivel se van a mostrar (para evitar calculos previos)
+inline int salida_activa(const SalidaOrdenada* s, int nivel)
+{
+    return nivel > SALIDA_RESUMEN && nivel <= s->nivel;
+}
+
+// Anade texto con formato printf al buffer local si su nivel esta activo
+inline void salida_printf(SalidaOrdenada* s, int nivel, const char* formato, ...)
+{
+    if (!salida_activa(s, nivel)) {
+        return;
+    }
+    va_list args;
+    va_start(args, formato);
+    int necesario = vsnprintf(NULL, 0, formato, args);
+    va_end(args);
+    if (necesario <= 0) {
+        return;
+    }
+    if (s->longitud + necesario + 1 > s->capacidad) {
+        size_t capacidad = s->capacidad > 0 ? s->capacidad * 2 : 256;
+        while (capacidad < s->longitud + necesario + 1) capacidad *= 2;
+        char* texto = (char*)realloc(s->texto, capacidad);
+        if (texto == NULL) {
+            fprintf(stderr, "ERROR: No se pudo ampliar el buffer de salida.\n");
+            MPI_Abort(s->comm, 1);
+        }
+        s->texto = texto;
+        s->capacidad = capacidad;
+    }
+    va_start(args, formato);
+    vsnprintf(s->texto + s->longitud, s->capacidad - s->longitud, formato, args);
+    va_end(args);
+    s->longitud += necesario;
+}
+
+/*
+   Operacion colectiva en s->comm: reune en la raiz el texto de todos los
+   procesos y lo escribe en 'f' en orden de rango con un solo fwrite. Vacia
+   los buffers locales, asi que se puede llamar varias veces.
+*/
+inline void salida_volcar(SalidaOrdenada* s, FILE* f)
+{
+    if (s->nivel == SALIDA_RESUMEN) {
+        return;
+    }
+    int mirango, tamano;
+    MPI_Comm_rank(s->comm, &mirango);
+    MPI_Comm_size(s->comm, &tamano);
+
+    int longitud = (int)s->longitud;
+    int* longitudes = NULL;
+    int* desplazamientos = NULL;
+    char* todo = NULL;
+    long long total = 0;
+    if (mirango == 0) {
+        longitudes = (int*)malloc(tamano * sizeof(int));
+        desplazamientos = (int*)malloc(tamano * sizeof(int));
+        if (longitudes == NULL || desplazamientos == NULL) {
+            fprintf(stderr, "ERROR: No se pudo asignar memoria para la salida ordenada.\n");
+            MPI_Abort(s->comm, 1);
+        }
+    }
+    MPI_Gather(&longitud, 1, MPI_INT, longitudes, 1, MPI_INT, 0, s->comm);
+    if (mirango == 0) {
+        for (int p = 0; p < tamano; p++) {
+            desplazamientos[p] = (int)total;
+            total += longitudes[p];
+        }
+        todo = (char*)malloc((size_t)(total > 0 ? total : 1));
+        if (todo == NULL) {
+            fprintf(stderr, "ERROR: No se pudo asignar memoria para la salida ordenada.\n");
+            MPI_Abort(s->comm, 1);
+        }
+    }
+    MPI_Gatherv(s->texto, longitud, MPI_CHAR, todo, longitudes, desplazamientos, MPI_CHAR, 0, s->comm);
+    if (mirango == 0) {
+        fwrite(todo, 1, (size_t)total, f);
+        fflush(f);
+    }
+    free(longitudes);
+    free(desplazamientos);
+    free(todo);
+    s->longitud = 0;
+}
+
+inline void salida_liberar(SalidaOrdenada* s)
+{
+    free(s->texto);
+    s->texto = NULL;
+    s->longitud = 0;
+    s->capacidad = 0;
+}
+
+#endif
@@ -1,5 +1,253 @@
 #include <mpi.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Parametros del modo benchmark (ping-pong entre el rango 0 y el rango 1)
+#define BENCH_TAM_MAX (64 * 1024 * 1024)      // Mayor mensaje medido: 64 MiB
+#define BENCH_ITERACIONES 5000                // Idas y vueltas por tamano (mensajes pequenos)
+#define BENCH_BYTES_POR_TAMANO (1LL << 31)    // Limite de bytes movidos por tamano
+#define BENCH_ITERACIONES_MIN 20
+#define BENCH_TAG 2001
+
+// Comparador para ordenar los tiempos con qsort y sacar mediana y percentiles
+int comparar_double(const void* a, const void* b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+// Con mensajes grandes no tiene sentido repetir miles de veces: se limita
+// el volumen total movido por tamano para que el barrido termine en un tiempo razonable
+int iteraciones_para_tamano(int bytes, int iteraciones)
+{
+	long long limite = BENCH_BYTES_POR_TAMANO / (2LL * bytes);
+	if (limite < iteraciones) {
+		iteraciones = (int)limite;
+	}
+	if (iteraciones < BENCH_ITERACIONES_MIN) {
+		iteraciones = BENCH_ITERACIONES_MIN;
+	}
+	return iteraciones;
+}
+
+// Modos de envio que se pueden comparar en el benchmark
+enum ModoEnvio { MODO_ESTANDAR, MODO_SINCRONO, MODO_BUFFER, MODO_READY, MODO_PERSISTENTE, NUM_MODOS };
+const char* nombres_modo[NUM_MODOS] = { "estandar", "sincrono", "buffer", "ready", "persistente" };
+
+// Estado asociado a un modo para un tamano de mensaje concreto
+typedef struct {
+	int modo;
+	int bytes;
+	int otro;                  // Rango con el que se hace el ping-pong
+	char* envio;               // Buffer de salida
+	char* recepcion;           // Buffer de entrada (separado: en ready y persistente hay
+	                           // una recepcion pendiente mientras se envia)
+	char* buffer_bsend;        // Buffer adjuntado con MPI_Buffer_attach (modo buffer)
+	MPI_Request pendiente;     // Recepcion pre-publicada (modo ready)
+	MPI_Request persistentes[2]; // [0] recepcion, [1] envio (modo persistente)
+} Transporte;
+
+int buscar_modo(const char* nombre)
+{
+	for (int m = 0; m < NUM_MODOS; m++) {
+		if (strcmp(nombre, nombres_modo[m]) == 0) {
+			return m;
+		}
+	}
+	return -1;
+}
+
+// Prepara lo que cada modo necesita antes de medir: el buffer de MPI_Bsend,
+// las peticiones persistentes o la primera recepcion pre-publicada de ready
+void preparar_transporte(Transporte* t, int modo, int mirango, char* envio, char* recepcion, int bytes)
+{
+	t->modo = modo;
+	t->bytes = bytes;
+	t->otro = 1 - mirango;
+	t->envio = envio;
+	t->recepcion = recepcion;
+	t->buffer_bsend = NULL;
+	t->pendiente = MPI_REQUEST_NULL;
+
+	if (modo == MODO_BUFFER) {
+		int tam = bytes + MPI_BSEND_OVERHEAD;
+		t->buffer_bsend = (char*)malloc(tam);
+		if (t->buffer_bsend == NULL) {
+			fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar el buffer de MPI_Bsend.\n", mirango);
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		MPI_Buffer_attach(t->buffer_bsend, tam);
+	}
+	else if (modo == MODO_READY) {
+		// MPI_Rsend exige que la recepcion ya este publicada en el destino.
+		// El rango 1 publica su primera recepcion y avisa al rango 0 con un
+		// mensaje vacio; a partir de ahi cada lado re-publica antes de contestar
+		if (mirango == 1) {
+			MPI_Irecv(recepcion, bytes, MPI_BYTE, 0, BENCH_TAG, MPI_COMM_WORLD, &t->pendiente);
+			MPI_Send(NULL, 0, MPI_BYTE, 0, BENCH_TAG + 1, MPI_COMM_WORLD);
+		}
+		else {
+			MPI_Recv(NULL, 0, MPI_BYTE, 1, BENCH_TAG + 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		}
+	}
+	else if (modo == MODO_PERSISTENTE) {
+		// Se crean una sola vez; cada mensaje solo cuesta un MPI_Start
+		MPI_Recv_init(recepcion, bytes, MPI_BYTE, t->otro, BENCH_TAG, MPI_COMM_WORLD, &t->persistentes[0]);
+		MPI_Send_init(envio, bytes, MPI_BYTE, t->otro, BENCH_TAG, MPI_COMM_WORLD, &t->persistentes[1]);
+	}
+}
+
+void liberar_transporte(Transporte* t)
+{
+	if (t->modo == MODO_BUFFER) {
+		int tam;
+		// MPI_Buffer_detach espera a que salgan los mensajes que siguen en el buffer
+		MPI_Buffer_detach(&t->buffer_bsend, &tam);
+		free(t->buffer_bsend);
+	}
+	else if (t->modo == MODO_READY && t->pendiente != MPI_REQUEST_NULL) {
+		// La ultima recepcion pre-publicada por el rango 1 no llega a casar
+		MPI_Cancel(&t->pendiente);
+		MPI_Wait(&t->pendiente, MPI_STATUS_IGNORE);
+	}
+	else if (t->modo == MODO_PERSISTENTE) {
+		MPI_Request_free(&t->persistentes[0]);
+		MPI_Request_free(&t->persistentes[1]);
+	}
+}
+
+// Una ida y vuelta: el rango 0 envia el mensaje y espera el eco del rango 1
+void ping_pong(Transporte* t, int mirango)
+{
+	int bytes = t->bytes;
+	int otro = t->otro;
+
+	switch (t->modo) {
+	case MODO_ESTANDAR:
+	case MODO_SINCRONO:
+	case MODO_BUFFER:
+		if (mirango == 1) {
+			MPI_Recv(t->recepcion, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		}
+		if (t->modo == MODO_ESTANDAR) {
+			MPI_Send(t->envio, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD);
+		}
+		else if (t->modo == MODO_SINCRONO) {
+			MPI_Ssend(t->envio, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD);
+		}
+		else {
+			MPI_Bsend(t->envio, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD);
+		}
+		if (mirango == 0) {
+			MPI_Recv(t->recepcion, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		}
+		break;
+
+	case MODO_READY:
+		if (mirango == 0) {
+			// El eco se publica antes del envio, asi el rango 1 puede usar MPI_Rsend
+			MPI_Irecv(t->recepcion, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD, &t->pendiente);
+			MPI_Rsend(t->envio, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD);
+			MPI_Wait(&t->pendiente, MPI_STATUS_IGNORE);
+		}
+		else {
+			MPI_Wait(&t->pendiente, MPI_STATUS_IGNORE);
+			// Publicar la siguiente recepcion antes de contestar
+			MPI_Irecv(t->recepcion, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD, &t->pendiente);
+			MPI_Rsend(t->envio, bytes, MPI_BYTE, otro, BENCH_TAG, MPI_COMM_WORLD);
+		}
+		break;
+
+	case MODO_PERSISTENTE:
+		if (mirango == 0) {
+			MPI_Startall(2, t->persistentes);
+			MPI_Waitall(2, t->persistentes, MPI_STATUSES_IGNORE);
+		}
+		else {
+			MPI_Start(&t->persistentes[0]);
+			MPI_Wait(&t->persistentes[0], MPI_STATUS_IGNORE);
+			MPI_Start(&t->persistentes[1]);
+			MPI_Wait(&t->persistentes[1], MPI_STATUS_IGNORE);
+		}
+		break;
+	}
+}
+
+// Siguiente tamano del barrido: se dobla y se termina exactamente en tam_max,
+// aunque no sea potencia de 2
+int siguiente_tamano(int bytes, int tam_max)
+{
+	long long doble = 2LL * bytes;
+	return doble < tam_max ? (int)doble : tam_max;
+}
+
+// Barrido de tamanos de 1 B a tam_max para cada modo pedido (o todos si modo < 0).
+// Solo participan los rangos 0 y 1; el rango 0 imprime una linea CSV por modo y
+// tamano con la latencia (mitad de la ida y vuelta) minima, mediana y p99 en
+// microsegundos y el ancho de banda sostenido en MB/s (10^6 bytes por segundo)
+void benchmark(int mirango, int tam_max, int iteraciones_base, int modo_pedido)
+{
+	char* envio = (char*)malloc(tam_max);
+	char* recepcion = (char*)malloc(tam_max);
+	int max_iteraciones = iteraciones_base > BENCH_ITERACIONES_MIN ? iteraciones_base : BENCH_ITERACIONES_MIN;
+	double* tiempos = (double*)malloc(max_iteraciones * sizeof(double));
+	if (envio == NULL || recepcion == NULL || tiempos == NULL) {
+		fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para el benchmark.\n", mirango);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	memset(envio, mirango, tam_max);
+	memset(recepcion, 0, tam_max);
+
+	if (mirango == 0) {
+		printf("modo,bytes,iteraciones,min_us,mediana_us,p99_us,ancho_banda_MBs\n");
+		fflush(stdout);
+	}
+
+	for (int modo = 0; modo < NUM_MODOS; modo++) {
+		if (modo_pedido >= 0 && modo != modo_pedido) {
+			continue;
+		}
+		for (int bytes = 1, ultimo = 0; !ultimo; bytes = siguiente_tamano(bytes, tam_max)) {
+			ultimo = bytes == tam_max;
+			int iteraciones = iteraciones_para_tamano(bytes, iteraciones_base);
+			int calentamiento = iteraciones / 10 > 2 ? iteraciones / 10 : 2;
+			Transporte t;
+
+			preparar_transporte(&t, modo, mirango, envio, recepcion, bytes);
+
+			// Calentamiento: establece conexiones y registra la memoria antes de medir
+			for (int i = 0; i < calentamiento; i++) {
+				ping_pong(&t, mirango);
+			}
+
+			double inicio_total = MPI_Wtime();
+			for (int i = 0; i < iteraciones; i++) {
+				double t0 = MPI_Wtime();
+				ping_pong(&t, mirango);
+				tiempos[i] = (MPI_Wtime() - t0) / 2.0;
+			}
+			double total = MPI_Wtime() - inicio_total;
+
+			liberar_transporte(&t);
+
+			if (mirango == 0) {
+				qsort(tiempos, iteraciones, sizeof(double), comparar_double);
+				int p99 = (int)(0.99 * (iteraciones - 1));
+				double ancho_banda = 2.0 * (double)bytes * iteraciones / total / 1e6;
+				printf("%s,%d,%d,%.3f,%.3f,%.3f,%.3f\n", nombres_modo[modo], bytes, iteraciones,
+					tiempos[0] * 1e6, tiempos[iteraciones / 2] * 1e6, tiempos[p99] * 1e6, ancho_banda);
+				fflush(stdout);
+			}
+		}
+	}
+
+	free(envio);
+	free(recepcion);
+	free(tiempos);
+}
+
 int main(int argc, char* argv[])
 {
 	int mirango, tamano;
@@ -11,6 +259,33 @@ int main(int argc, char* argv[])
 	MPI_Get_processor_name(nombre, &longitud);
 	MPI_Status estado;
 
+	// Modo no interactivo:
+	// mpiexec -n 2 "Practica 1.exe" bench [tam_max] [iteraciones] [modo]
+	// modo: estandar, sincrono, buffer, ready, persistente o todos (por defecto)
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		// Se lee en 64 bits para rechazar tamanos que no caben en un int en vez de truncarlos
+		long long tam_pedido = argc > 2 ? atoll(argv[2]) : BENCH_TAM_MAX;
+		int iteraciones = argc > 3 ? atoi(argv[3]) : BENCH_ITERACIONES;
+		int modo = -1;
+		if (argc > 4 && strcmp(argv[4], "todos") != 0) {
+			modo = buscar_modo(argv[4]);
+		}
+		if (tamano < 2 || tam_pedido < 1 || tam_pedido > BENCH_TAM_MAX || iteraciones < 1 || (argc > 4 && modo < 0 && strcmp(argv[4], "todos") != 0)) {
+			if (mirango == 0) {
+				printf("Uso: mpiexec -n 2 Practica1.exe bench [tam_max_bytes] [iteraciones] "
+					"[estandar|sincrono|buffer|ready|persistente|todos]\n");
+				printf("     tam_max_bytes entre 1 y %d\n", BENCH_TAM_MAX);
+			}
+			MPI_Finalize();
+			return 1;
+		}
+		if (mirango < 2) {
+			benchmark(mirango, (int)tam_pedido, iteraciones, modo);
+		}
+		MPI_Finalize();
+		return 0;
+	}
+
 	// Pedir un dato al usuario y el rango 0 manda lo envia als rango 1
 	int num = 0;
 	if (mirango == 0) {
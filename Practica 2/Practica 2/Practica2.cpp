@@ -1,7 +1,159 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "aleatorio.h"
+#include "kernels_simd.h"
+#include "matriz_binaria.h"
+#include "pistas_es.h"
+
+// A partir de este tamano no se imprimen las matrices por consola
+#define N_MAX_IMPRESION 10
+
+// Reparto equilibrado de N filas entre tamano procesos: los primeros
+// N % tamano procesos se llevan una fila mas. Contamos en filas (no en
+// enteros) para que los desplazamientos no desborden un int con N grandes
+void calcular_reparto(int N, int tamano, int* filas, int* desplazamientos)
+{
+    int base = N / tamano;
+    int resto = N % tamano;
+    int desplazamiento = 0;
+    for (int p = 0; p < tamano; p++) {
+        filas[p] = base + (p < resto ? 1 : 0);
+        desplazamientos[p] = desplazamiento;
+        desplazamiento += filas[p];
+    }
+}
+
+void imprimir_matriz(const char* titulo, int* M, int N)
+{
+    printf("\n%s\n", titulo);
+    for (long long i = 0; i < (long long)N * N; i++) {
+        printf("%3d ", M[i]);
+        // Detectar si hay que imprimir el salto de linea o no
+        // para imprimir la matriz en la consola correctamente
+        // Dado que accedemos de forma contigua
+        if ((i + 1) % N == 0) {
+            printf("\n");
+        }
+    }
+}
+
+// =============================================================================
+// MICROBENCHMARK DE LOS NUCLEOS SIMD
+// =============================================================================
+#define SIMD_N_DEFECTO (1 << 24)     // 16 Mi elementos: muy por encima de la cache
+#define SIMD_REPETICIONES 10
+
+// Resultado de una medida: mejor tiempo (como hace STREAM) en segundos
+typedef struct {
+    double simple;
+    double simd;
+    int correcto;
+} MedidaSimd;
+
+template <typename T>
+MedidaSimd medir_suma(T* a, T* b, T* c, T* referencia, size_t n, int repeticiones)
+{
+    MedidaSimd m = { 1e30, 1e30, 1 };
+    for (int r = 0; r < repeticiones; r++) {
+        double t0 = MPI_Wtime();
+        simd_sumar_escalar(a, b, referencia, n);
+        double t1 = MPI_Wtime();
+        simd_sumar(a, b, c, n);
+        double t2 = MPI_Wtime();
+        if (t1 - t0 < m.simple) m.simple = t1 - t0;
+        if (t2 - t1 < m.simd) m.simd = t2 - t1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (c[i] != referencia[i]) {
+            m.correcto = 0;
+            break;
+        }
+    }
+    return m;
+}
+
+template <typename T, typename Acum>
+MedidaSimd medir_producto(T* x, T* y, size_t n, int repeticiones)
+{
+    MedidaSimd m = { 1e30, 1e30, 1 };
+    Acum simple = 0, vectorial = 0;
+    for (int r = 0; r < repeticiones; r++) {
+        double t0 = MPI_Wtime();
+        simple = simd_producto_escalar<T, Acum>(x, y, n);
+        double t1 = MPI_Wtime();
+        vectorial = simd_producto(x, y, n);
+        double t2 = MPI_Wtime();
+        if (t1 - t0 < m.simple) m.simple = t1 - t0;
+        if (t2 - t1 < m.simd) m.simd = t2 - t1;
+    }
+    // Los reales se suman en otro orden: se admite un error relativo pequeno
+    double diferencia = (double)simple - (double)vectorial;
+    double escala = (double)simple != 0 ? (double)simple : 1.0;
+    m.correcto = (diferencia / escala < 1e-9 && diferencia / escala > -1e-9);
+    return m;
+}
+
+// Todos los procesos miden a la vez (como en una ejecucion real, compitiendo por
+// la memoria del nodo); el proceso 0 imprime sus GB/s y el agregado de todos
+void informar_simd(int mirango, const char* kernel, const char* tipo, MedidaSimd m, double bytes)
+{
+    double local[2] = { bytes / m.simple / 1e9, bytes / m.simd / 1e9 };
+    double agregado[2];
+    int correcto;
+    MPI_Reduce(local, agregado, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&m.correcto, &correcto, 1, MPI_INT, MPI_LAND, 0, MPI_COMM_WORLD);
+    if (mirango == 0) {
+        printf("%-9s %-7s %12.2f %12.2f %8.2fx %14.2f %14.2f  %s\n", kernel, tipo,
+            local[0], local[1], m.simple / m.simd, agregado[0], agregado[1], correcto ? "OK" : "ERROR");
+        fflush(stdout);
+    }
+}
+
+template <typename T, typename Acum>
+void benchmark_tipo(int mirango, const char* tipo, size_t n, int repeticiones)
+{
+    T* a = (T*)malloc(n * sizeof(T));
+    T* b = (T*)malloc(n * sizeof(T));
+    T* c = (T*)malloc(n * sizeof(T));
+    T* referencia = (T*)malloc(n * sizeof(T));
+    if (a == NULL || b == NULL || c == NULL || referencia == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para el benchmark.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        a[i] = (T)aleatorio_entero(mirango + 1, i, 1, 50);
+        b[i] = (T)aleatorio_entero(mirango + 1, n + i, 1, 50);
+    }
+    // Primera pasada para que todas las paginas esten ya mapeadas al medir
+    simd_sumar_escalar(a, b, c, n);
+    simd_sumar_escalar(a, b, referencia, n);
+
+    MedidaSimd m = medir_suma(a, b, c, referencia, n, repeticiones);
+    informar_simd(mirango, "suma", tipo, m, 3.0 * n * sizeof(T));
+    m = medir_producto<T, Acum>(a, b, n, repeticiones);
+    informar_simd(mirango, "producto", tipo, m, 2.0 * n * sizeof(T));
+
+    free(a); free(b); free(c); free(referencia);
+}
+
+// Uso: mpiexec -n P Practica2.exe simd [elementos] [repeticiones] [escalar|avx2|avx512]
+void benchmark_simd(int mirango, int tamano, size_t n, int repeticiones)
+{
+    if (mirango == 0) {
+        printf("Microbenchmark SIMD: %zu elementos por proceso, %d procesos, mejor de %d repeticiones\n",
+            n, tamano, repeticiones);
+        printf("Nivel SIMD en uso: %s\n\n", simd_nombre_nivel(simd_nivel()));
+        printf("%-9s %-7s %12s %12s %9s %14s %14s\n", "kernel", "tipo",
+            "simple GB/s", "SIMD GB/s", "mejora", "total simple", "total SIMD");
+    }
+    benchmark_tipo<int32_t, long long>(mirango, "int32", n, repeticiones);
+    benchmark_tipo<int64_t, long long>(mirango, "int64", n, repeticiones);
+    benchmark_tipo<float, double>(mirango, "float", n, repeticiones);
+    benchmark_tipo<double, double>(mirango, "double", n, repeticiones);
+}
 
 int main(int argc, char* argv[])
 {
@@ -12,104 +164,283 @@ int main(int argc, char* argv[])
     MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
     MPI_Comm_size(MPI_COMM_WORLD, &tamano);
 
-    // El proceso 0 pide el tamano de la matriz
+    if (argc > 1 && strcmp(argv[1], "simd") == 0) {
+        size_t n = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : SIMD_N_DEFECTO;
+        int repeticiones = argc > 3 ? atoi(argv[3]) : SIMD_REPETICIONES;
+        if (argc > 4) {
+            // Limitar el nivel para comparar implementaciones en la misma maquina
+            simd_forzar_nivel(strcmp(argv[4], "avx512") == 0 ? SIMD_AVX512
+                : (strcmp(argv[4], "avx2") == 0 ? SIMD_AVX2 : SIMD_ESCALAR));
+        }
+        benchmark_simd(mirango, tamano, n, repeticiones > 0 ? repeticiones : 1);
+        MPI_Finalize();
+        return 0;
+    }
+
+    // El proceso 0 pide el tamano de la matriz (o lo toma del primer argumento)
     // En nuestro caso, queremos que el minimoo que se pueda calcular sea
     // una matriz 2x2
     if (mirango == 0) {
-        do {
+        N = argc > 1 ? atoi(argv[1]) : 0;
+        while (N < 2) {
             printf("Introduce un numero para la matriz NxN: ");
             fflush(stdout);
             scanf_s("%d", &N);
             if (N < 2) {
                 printf("El numero tiene que ser mayor o igual que 2\n");
             }
-        } while (N < 2);
+        }
     }
 
     // Enviamos N a todos los procesos para que sepan el tamano de la matriz
     // Depues de hacer este broadcast, todos los procesos ya pueden trabajar con el valor de N
     MPI_Bcast(&N, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    // Verificamos que el nmero de procesos sea igual a N
-    if (tamano != N) {
-        if (mirango == 0) {
-            printf("Error: El numero de procesos debe ser igual a N=%d\n", N);
-        }    
-        MPI_Finalize();
-        return 0;
-    }
+    // Cada proceso se queda con un bloque de filas contiguas. Ya no hace falta
+    // que el numero de procesos sea igual a N: sobran o faltan filas da igual
+    int* filas = (int*)malloc(tamano * sizeof(int));
+    int* desplazamientos = (int*)malloc(tamano * sizeof(int));
+    calcular_reparto(N, tamano, filas, desplazamientos);
+    int misfilas = filas[mirango];
+    size_t elementos_locales = (size_t)misfilas * N;
 
-    // Creamos la matrices dinmicas y reservamos memoria para sus valores
-    int* A = (int*)malloc(N * N * sizeof(int));
-    int* B = (int*)malloc(N * N * sizeof(int));
-    int* C = (int*)malloc(N * N * sizeof(int));
-    int* filaC = (int*)malloc(N * sizeof(int));
+    // Tipo derivado para una fila completa: los contadores de Scatterv/Gatherv van en filas
+    MPI_Datatype tipo_fila;
+    MPI_Type_contiguous(N, MPI_INT, &tipo_fila);
+    MPI_Type_commit(&tipo_fila);
 
-    double inicio, fin; // Variables para medir el rendimiento
+    // Modo de distribucion (segundo argumento):
+    //  - bloques (por defecto): cada proceso recibe y reserva solo su bloque de filas
+    //  - bcast: version original, A y B completas se difunden a todos los procesos
+    //  - local: cada proceso genera su propio bloque, no se reparte nada
+    int modo_bcast = argc > 2 && strcmp(argv[2], "bcast") == 0;
+    int modo_local = argc > 2 && strcmp(argv[2], "local") == 0;
 
-    // Inicializamos matrices A y B solo en el proceso 0
-    // Generando numeros aleatorios entre 1 y 50
+    // Semilla global (tercer argumento o reloj). Con la misma semilla las matrices
+    // son identicas en cualquier modo y con cualquier numero de procesos
+    semilla_t semilla = 0;
     if (mirango == 0) {
-        // Cambiamos la semilla para evitar la misma secuencia de numeros aleatorios
-        srand(time(NULL)); 
-        printf("\nMatriz A:\n");
-        for (int i = 0; i < N * N; i++) {
-            A[i] = rand() % 50 + 1;
-            printf("%3d ", A[i]);
-            if ((i + 1) % N == 0) {
-                printf("\n");
-            }
-        }
+        semilla = argc > 3 ? strtoull(argv[3], NULL, 10) : aleatorio_semilla_reloj();
+    }
+    MPI_Bcast(&semilla, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+    semilla_t semillaA = aleatorio_flujo(semilla, 0);
+    semilla_t semillaB = aleatorio_flujo(semilla, 1);
 
-        printf("\nMatriz B:\n");
-        for (int i = 0; i < N * N; i++) {
-            B[i] = rand() % 50 + 1;
-            printf("%3d ", B[i]);
-            if ((i + 1) % N == 0) {
-                printf("\n");
-            }
-        }
-        printf("\n");
+    // Creamos la matrices dinmicas y reservamos memoria para sus valores
+    // A y B completas solo existen en el proceso 0 (en todos en modo bcast, en
+    // ninguno en modo local); C completa solo en el proceso 0
+    size_t elementos = (size_t)N * N;
+    size_t elementos_A = ((mirango == 0 && !modo_local) || modo_bcast) ? elementos : 0;
+    size_t elementos_C = (mirango == 0) ? elementos : 0;
+    int* A = NULL;
+    int* B = NULL;
+    int* C = NULL;
+    int* bloqueA;
+    int* bloqueB;
+    int* bloqueC;
+    size_t memoria_local = 0;   // Bytes reservados por este proceso para datos de matrices
+
+    if (elementos_A > 0) {
+        A = (int*)malloc(elementos_A * sizeof(int));
+        B = (int*)malloc(elementos_A * sizeof(int));
+        memoria_local += 2 * elementos_A * sizeof(int);
+    }
+    if (elementos_C > 0) {
+        C = (int*)malloc(elementos_C * sizeof(int));
+        memoria_local += elementos_C * sizeof(int);
+    }
+
+    // El bloque de cada proceso apunta dentro de la matriz completa cuando la tiene;
+    // el proceso 0 trabaja siempre in situ sobre A, B y C
+    size_t inicio_bloque = (size_t)desplazamientos[mirango] * N;
+    if (A != NULL) {
+        bloqueA = A + inicio_bloque;
+        bloqueB = B + inicio_bloque;
+    }
+    else {
+        bloqueA = (int*)malloc((elementos_locales > 0 ? elementos_locales : 1) * sizeof(int));
+        bloqueB = (int*)malloc((elementos_locales > 0 ? elementos_locales : 1) * sizeof(int));
+        memoria_local += 2 * elementos_locales * sizeof(int);
+    }
+    if (C != NULL) {
+        bloqueC = C + inicio_bloque;
     }
+    else {
+        bloqueC = (int*)malloc((elementos_locales > 0 ? elementos_locales : 1) * sizeof(int));
+        memoria_local += elementos_locales * sizeof(int);
+    }
+    if ((elementos_A > 0 && (A == NULL || B == NULL)) || (elementos_C > 0 && C == NULL)
+        || bloqueA == NULL || bloqueB == NULL || bloqueC == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para las matrices.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    double inicio, fin; // Variables para medir el rendimiento
+    double fin_datos;   // Momento en que este proceso tiene su bloque de A y B listo
 
-    // Sincronizamos y medimos 
+    // Sincronizamos y medimos
     // Sincronizamos con MPI_Barrier para poder medir el tiempo correctamente
     // y para que se mida cuando comiencen la suma todos los procesos
+    // La generacion de los datos entra en la medida: con N grande es lo que mas cuesta
     MPI_Barrier(MPI_COMM_WORLD);
     inicio = MPI_Wtime();
 
-    // Enviamos matrices a todos los procesos
-    MPI_Bcast(A, N * N, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(B, N * N, MPI_INT, 0, MPI_COMM_WORLD);
+    // Bytes que llegan a este proceso y bytes que salen de el hacia el proceso 0
+    long long bytes_recibidos = 0, bytes_enviados = 0;
+    if (modo_local) {
+        // Cada proceso genera directamente su bloque de filas con numeros entre 1 y 50
+        aleatorio_rellenar(bloqueA, elementos_locales, semillaA, inicio_bloque, 1, 50);
+        aleatorio_rellenar(bloqueB, elementos_locales, semillaB, inicio_bloque, 1, 50);
+    }
+    else {
+        // Inicializamos matrices A y B solo en el proceso 0
+        // Generando numeros aleatorios entre 1 y 50
+        if (mirango == 0) {
+            aleatorio_rellenar(A, elementos, semillaA, 0, 1, 50);
+            aleatorio_rellenar(B, elementos, semillaB, 0, 1, 50);
+        }
+
+        if (modo_bcast) {
+            // Version original: todos reciben A y B completas aunque solo usen su bloque.
+            // Se cuentan N filas y no N*N enteros, que no caben en un int con N > 46340
+            MPI_Bcast(A, N, tipo_fila, 0, MPI_COMM_WORLD);
+            MPI_Bcast(B, N, tipo_fila, 0, MPI_COMM_WORLD);
+            if (mirango != 0) {
+                bytes_recibidos = 2LL * (long long)elementos * sizeof(int);
+            }
+        }
+        else {
+            // Repartimos a cada proceso su bloque de filas de A y de B; el proceso 0
+            // ya tiene el suyo en su sitio y no se lo copia a si mismo
+            if (mirango == 0) {
+                MPI_Scatterv(A, filas, desplazamientos, tipo_fila, MPI_IN_PLACE, misfilas, tipo_fila, 0, MPI_COMM_WORLD);
+                MPI_Scatterv(B, filas, desplazamientos, tipo_fila, MPI_IN_PLACE, misfilas, tipo_fila, 0, MPI_COMM_WORLD);
+            }
+            else {
+                MPI_Scatterv(NULL, NULL, NULL, tipo_fila, bloqueA, misfilas, tipo_fila, 0, MPI_COMM_WORLD);
+                MPI_Scatterv(NULL, NULL, NULL, tipo_fila, bloqueB, misfilas, tipo_fila, 0, MPI_COMM_WORLD);
+                bytes_recibidos = 2LL * (long long)elementos_locales * sizeof(int);
+            }
+        }
+    }
+    fin_datos = MPI_Wtime();
+
+    // Cada proceso calcula sus filas con el nucleo vectorial que soporte la CPU
+    simd_sumar(bloqueA, bloqueB, bloqueC, elementos_locales);
 
-    // Cada proceso calcula su fila
-    int fila = mirango;
-    for (int i = 0; i < N; i++) {
-        filaC[i] = A[fila * N + i] + B[fila * N + i];
+    // Suma de control de C ponderada por la posicion global de cada elemento:
+    // con la misma semilla debe salir igual en cualquier modo y numero de procesos
+    unsigned long long control_local = 0, control = 0;
+    for (size_t i = 0; i < elementos_locales; i++) {
+        control_local += (unsigned long long)bloqueC[i] * (inicio_bloque + i + 1);
     }
+    MPI_Reduce(&control_local, &control, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 
-    // Recolectamos resultados en C (hecho por cada proceso)
-    MPI_Gather(filaC, N, MPI_INT, C, N, MPI_INT, 0, MPI_COMM_WORLD);
+    // Recolectamos los bloques de C en el proceso 0
+    if (mirango == 0) {
+        MPI_Gatherv(MPI_IN_PLACE, misfilas, tipo_fila, C, filas, desplazamientos, tipo_fila, 0, MPI_COMM_WORLD);
+    }
+    else {
+        MPI_Gatherv(bloqueC, misfilas, tipo_fila, NULL, NULL, NULL, tipo_fila, 0, MPI_COMM_WORLD);
+        bytes_enviados = (long long)elementos_locales * sizeof(int);
+    }
 
     MPI_Barrier(MPI_COMM_WORLD);
     fin = MPI_Wtime();
 
+    // Guardar C en formato binario (cuarto argumento): cada proceso escribe su
+    // bloque de filas directamente en su sitio del fichero, sin pasar por el 0
+    const char* fichero = argc > 4 ? argv[4] : NULL;
+    int resultado_fichero = MATRIZ_OK;
+    double tiempo_fichero = 0.0;
+    if (fichero != NULL) {
+        MPI_Info pistas = pistas_cargar(MPI_COMM_WORLD);
+        int malla[2] = { tamano, 1 };
+        double t0 = MPI_Wtime();
+        resultado_fichero = matriz_escribir(MPI_COMM_WORLD, fichero, pistas, MATRIZ_ENTERO, N, N,
+            MATRIZ_FILAS, malla, bloqueC, matriz_tesela(desplazamientos[mirango], 0, misfilas, N, N), NULL);
+        tiempo_fichero = MPI_Wtime() - t0;
+        MPI_Info_free(&pistas);
+    }
+
+    // El tiempo de preparacion de los datos lo marca el proceso mas lento
+    double tiempo_datos_local = fin_datos - inicio, tiempo_datos;
+    MPI_Reduce(&tiempo_datos_local, &tiempo_datos, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Informe de memoria y trafico por proceso, recogido en el proceso 0
+    long long informe[3] = { (long long)memoria_local, bytes_recibidos, bytes_enviados };
+    long long* informes = NULL;
     if (mirango == 0) {
-        printf("Matriz C = A + B:\n");
-        for (int i = 0; i < N * N; i++) {
-            printf("%3d ", C[i]);
-            // Detectar si hay que imprimir el salto de linea o no
-            // para imprimir la matriz en la consola correctamente
-            // Dado que accedemos de forma contigua
-            if ((i + 1) % N == 0) {
-                printf("\n");
+        informes = (long long*)malloc(3 * tamano * sizeof(long long));
+        if (informes == NULL) {
+            fprintf(stderr, "ERROR: No se pudo asignar memoria para el informe de %d procesos.\n", tamano);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(informe, 3, MPI_LONG_LONG, informes, 3, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+
+    if (mirango == 0) {
+        printf("Reparto: %d filas entre %d procesos (%d o %d filas por proceso), distribucion %s\n",
+            N, tamano, filas[tamano - 1], filas[0], modo_bcast ? "bcast" : (modo_local ? "local" : "bloques"));
+        printf("Semilla: %llu\n", semilla);
+        if (N <= N_MAX_IMPRESION) {
+            // Se regeneran a partir de la semilla: en modo local el proceso 0 no tiene A ni B
+            int* copia = (int*)malloc(elementos * sizeof(int));
+            if (copia == NULL) {
+                fprintf(stderr, "ERROR: No se pudo asignar memoria para mostrar las matrices.\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            aleatorio_rellenar(copia, elementos, semillaA, 0, 1, 50);
+            imprimir_matriz("Matriz A:", copia, N);
+            aleatorio_rellenar(copia, elementos, semillaB, 0, 1, 50);
+            imprimir_matriz("Matriz B:", copia, N);
+            free(copia);
+            imprimir_matriz("Matriz C = A + B:", C, N);
+        }
+        printf("\nSuma de control de C: %llu\n", control);
+        if (fichero != NULL) {
+            printf("Matriz C guardada en '%s' (%.3f MB en %f segundos): %s\n", fichero,
+                (MATRIZ_DATOS + (double)elementos * sizeof(int)) / 1e6, tiempo_fichero,
+                matriz_mensaje(resultado_fichero));
+        }
+
+        long long memoria_max_resto = 0, trafico_total = 0;
+        printf("\nMemoria y trafico por proceso (MB = 10^6 bytes):\n");
+        for (int p = 0; p < tamano; p++) {
+            long long memoria = informes[3 * p], recibidos = informes[3 * p + 1], enviados = informes[3 * p + 2];
+            if (p > 0 && memoria > memoria_max_resto) {
+                memoria_max_resto = memoria;
+            }
+            trafico_total += recibidos + enviados;
+            if (tamano <= 16) {
+                printf("  [Proceso %2d] memoria %10.3f MB  recibidos %10.3f MB  enviados %10.3f MB\n",
+                    p, memoria / 1e6, recibidos / 1e6, enviados / 1e6);
             }
         }
-        printf("\nTiempo de ejecucion: %f segundos\n", fin - inicio);
+        // Referencia: lo que moveria el esquema original (A y B completas a los P-1 procesos
+        // y sus bloques de C de vuelta) para comparar con el modo elegido
+        long long trafico_bcast = 2LL * (tamano - 1) * (long long)elementos * sizeof(int)
+            + (long long)(elementos - (size_t)filas[0] * N) * sizeof(int);
+        printf("  Memoria proceso 0: %.3f MB, maxima en el resto: %.3f MB\n",
+            informes[0] / 1e6, memoria_max_resto / 1e6);
+        printf("  Trafico total: %.3f MB (%.1f%% del esquema con MPI_Bcast)\n",
+            trafico_total / 1e6, trafico_bcast > 0 ? 100.0 * trafico_total / trafico_bcast : 100.0);
+        free(informes);
+
+        printf("\nTiempo de generacion y reparto: %f segundos\n", tiempo_datos);
+        printf("Tiempo de ejecucion: %f segundos\n", fin - inicio);
     }
 
     // Liberar la memoria dado que hemos reservado memoria de forma dinamica
-    free(A); free(B); free(C); free(filaC);
+    MPI_Type_free(&tipo_fila);
+    if (A == NULL) {
+        free(bloqueA); free(bloqueB);
+    }
+    if (C == NULL) {
+        free(bloqueC);
+    }
+    free(A); free(B); free(C);
+    free(filas); free(desplazamientos);
     MPI_Finalize();
     return 0;
 }
@@ -1,7 +1,37 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "aleatorio.h"
+
+// A partir de este tamao no se imprimen las matrices por consola
+#define N_MAX_IMPRESION 10
+
+// Reparto equilibrado de N columnas entre tamano procesos: los primeros
+// N % tamano procesos se llevan una columna ms
+void calcular_reparto(int N, int tamano, int* columnas, int* desplazamientos)
+{
+    int base = N / tamano;
+    int resto = N % tamano;
+    int desplazamiento = 0;
+    for (int p = 0; p < tamano; p++) {
+        columnas[p] = base + (p < resto ? 1 : 0);
+        desplazamientos[p] = desplazamiento;
+        desplazamiento += columnas[p];
+    }
+}
+
+// Imprime una matriz NN almacenada por filas de forma contigua
+void imprimir_matriz(const char* titulo, int* M, int N)
+{
+    printf("\n%s\n", titulo);
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++)
+            printf("%4d ", M[(size_t)i * N + j]);
+        printf("\n");
+    }
+}
 
 int main(int argc, char* argv[])
 {
@@ -14,109 +44,149 @@ int main(int argc, char* argv[])
 
     int N = 0;
 
-    // Proceso 0 pide N al usuario
+    // Proceso 0 pide N al usuario (o lo toma del primer argumento)
     if (mirango == 0) {
-        /** do {
-             printf("Introduce el tamao N de la matriz cuadrada: ");
-             fflush(stdout);
-             scanf_s("%d", &N);
-             if (N <= 0) printf("Error: N debe ser mayor que 0.\n");
-         } while (N <= 0);
-         **/
-        N = 1;
+        N = argc > 1 ? atoi(argv[1]) : 0;
+        while (N <= 0) {
+            printf("Introduce el tamao N de la matriz cuadrada: ");
+            fflush(stdout);
+            scanf_s("%d", &N);
+            if (N <= 0) printf("Error: N debe ser mayor que 0.\n");
+        }
     }
 
     // Compartir N con todos los procesos
     MPI_Bcast(&N, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    // Comprobar que el nmero de procesos coincide con N
-    if (tamano != N) {
-        if (mirango == 0)
-            printf("Error: el nmero de procesos (%d) debe ser igual a N (%d)\n", tamano, N);
-        MPI_Finalize();
-        return 1;
+    // Semilla global (segundo argumento o reloj) compartida por todos los procesos
+    semilla_t semilla = 0;
+    if (mirango == 0) {
+        semilla = argc > 2 ? strtoull(argv[2], NULL, 10) : aleatorio_semilla_reloj();
     }
-
-    // Reservar memoria dinmica para matrices 2D
-    int** A = (int**)malloc(N * sizeof(int*));
-    int** B = (int**)malloc(N * sizeof(int*));
-    int** C = (int**)malloc(N * sizeof(int*));
-    for (int i = 0; i < N; i++) {
-        A[i] = (int*)malloc(N * sizeof(int));
-        B[i] = (int*)malloc(N * sizeof(int));
-        C[i] = (int*)malloc(N * sizeof(int));
+    MPI_Bcast(&semilla, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+    semilla_t semillaA = aleatorio_flujo(semilla, 0);
+    semilla_t semillaB = aleatorio_flujo(semilla, 1);
+
+    // Generacin (tercer argumento):
+    //  - raiz (por defecto): el proceso 0 genera A y B y reparte bloques de columnas
+    //  - local: cada proceso genera sus propias columnas
+    int generacion_local = argc > 3 && strcmp(argv[3], "local") == 0;
+
+    // Cada proceso se queda con un bloque de columnas contiguas; sirve cualquier
+    // nmero de procesos (los que sobren se quedan con 0 columnas)
+    int* columnas = (int*)malloc(tamano * sizeof(int));
+    int* desplazamientos = (int*)malloc(tamano * sizeof(int));
+    calcular_reparto(N, tamano, columnas, desplazamientos);
+    int miscolumnas = columnas[mirango];
+    int primera_columna = desplazamientos[mirango];
+    size_t elementos_locales = (size_t)miscolumnas * N;
+
+    /*
+       Tipo derivado para una columna de una matriz NN guardada por filas:
+       N bloques de 1 entero separados N enteros entre s. Se redimensiona su
+       extensin a un entero para que la columna j+1 empiece justo despus de
+       la columna j; as los contadores y desplazamientos de Scatterv/Gatherv
+       se expresan directamente en columnas.
+    */
+    MPI_Datatype tipo_vector, tipo_columna;
+    MPI_Type_vector(N, 1, N, MPI_INT, &tipo_vector);
+    MPI_Type_create_resized(tipo_vector, 0, sizeof(int), &tipo_columna);
+    MPI_Type_commit(&tipo_columna);
+    MPI_Type_free(&tipo_vector);
+
+    // En el bloque local cada columna son N enteros seguidos: se cuenta en
+    // columnas y no en enteros, que no caben en un int cuando N * columnas > INT_MAX
+    MPI_Datatype tipo_columna_local;
+    MPI_Type_contiguous(N, MPI_INT, &tipo_columna_local);
+    MPI_Type_commit(&tipo_columna_local);
+
+    // Matrices completas con almacenamiento contiguo (solo en el proceso 0)
+    int* A = NULL;
+    int* B = NULL;
+    int* C = NULL;
+    if (mirango == 0) {
+        size_t elementos = (size_t)N * N;
+        A = (int*)malloc(elementos * sizeof(int));
+        B = (int*)malloc(elementos * sizeof(int));
+        C = (int*)malloc(elementos * sizeof(int));
+        if (A == NULL || B == NULL || C == NULL) {
+            fprintf(stderr, "ERROR: No se pudo asignar memoria para las matrices.\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
     }
 
-    // Cada proceso tiene un array para su columna
-    int* colA = (int*)malloc(N * sizeof(int));
-    int* colB = (int*)malloc(N * sizeof(int));
-    int* colC = (int*)malloc(N * sizeof(int));
+    // Bloque local de columnas, guardado por columnas: la columna k ocupa
+    // colX[k*N .. k*N + N-1]
+    int* colA = (int*)malloc((elementos_locales > 0 ? elementos_locales : 1) * sizeof(int));
+    int* colB = (int*)malloc((elementos_locales > 0 ? elementos_locales : 1) * sizeof(int));
+    int* colC = (int*)malloc((elementos_locales > 0 ? elementos_locales : 1) * sizeof(int));
+    if (colA == NULL || colB == NULL || colC == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para las columnas.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
     // Inicializar matrices en proceso 0 con nmeros aleatorios
-    if (mirango == 0) {
-        srand(time(NULL));
-        for (int i = 0; i < N; i++)
-            for (int j = 0; j < N; j++) {
-                A[i][j] = rand() % 100; // 0..99
-                B[i][j] = rand() % 100;
-            }
-
-        // Mostrar matrices generadas
-        printf("\nMatrices generadas por el proceso 0:\n");
+    if (mirango == 0 && (!generacion_local || N <= N_MAX_IMPRESION)) {
+        aleatorio_rellenar(A, (size_t)N * N, semillaA, 0, 0, 99); // 0..99
+        aleatorio_rellenar(B, (size_t)N * N, semillaB, 0, 0, 99);
+    }
 
-        printf("\nMatriz A:\n");
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++)
-                printf("%4d ", A[i][j]);
-            printf("\n");
-        }
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t1 = MPI_Wtime(); // tiempo inicio clculo
 
-        printf("\nMatriz B:\n");
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++)
-                printf("%4d ", B[i][j]);
-            printf("\n");
+    if (generacion_local) {
+        // Cada proceso genera sus columnas a partir de la posicin global (i, j)
+        for (int k = 0; k < miscolumnas; k++) {
+            for (int i = 0; i < N; i++) {
+                unsigned long long posicion = (unsigned long long)i * N + primera_columna + k;
+                colA[(size_t)k * N + i] = aleatorio_entero(semillaA, posicion, 0, 99);
+                colB[(size_t)k * N + i] = aleatorio_entero(semillaB, posicion, 0, 99);
+            }
         }
     }
-
-    // Enviar matrices completas a todos los procesos usando MPI_Bcast
-    for (int i = 0; i < N; i++) {
-        MPI_Bcast(A[i], N, MPI_INT, 0, MPI_COMM_WORLD);
-        MPI_Bcast(B[i], N, MPI_INT, 0, MPI_COMM_WORLD);
+    else {
+        // Repartir bloques de columnas: el proceso 0 enva 'columnas[p]' columnas
+        // con el tipo derivado y cada proceso las recibe como columnas contiguas
+        MPI_Scatterv(A, columnas, desplazamientos, tipo_columna,
+            colA, miscolumnas, tipo_columna_local, 0, MPI_COMM_WORLD);
+        MPI_Scatterv(B, columnas, desplazamientos, tipo_columna,
+            colB, miscolumnas, tipo_columna_local, 0, MPI_COMM_WORLD);
     }
 
-    double t1 = MPI_Wtime(); // tiempo inicio clculo
-
-    // Cada proceso extrae su columna y calcula la suma
-    for (int i = 0; i < N; i++) {
-        colA[i] = A[i][mirango];
-        colB[i] = B[i][mirango];
+    // Cada proceso suma sus columnas
+    for (size_t i = 0; i < elementos_locales; i++) {
         colC[i] = colA[i] + colB[i];
     }
 
-    // Recolectar columnas en el proceso 0 usando MPI_Gather
-    MPI_Gather(colC, N, MPI_INT, C[0], N, MPI_INT, 0, MPI_COMM_WORLD);
+    // Recolectar las columnas en su sitio dentro de C (por filas) en el proceso 0
+    MPI_Gatherv(colC, miscolumnas, tipo_columna_local,
+        C, columnas, desplazamientos, tipo_columna, 0, MPI_COMM_WORLD);
 
     double t2 = MPI_Wtime(); // tiempo fin clculo
 
-    // Proceso 0 reconstruye la matriz C y la imprime
+    // Proceso 0 imprime la matriz C
     if (mirango == 0) {
-        printf("\nMatriz C = A + B:\n");
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++)
-                printf("%4d ", C[i][j]);
-            printf("\n");
+        printf("\nN = %d, %d procesos, bloques de %d o %d columnas, generacion %s, semilla %llu\n",
+            N, tamano, columnas[tamano - 1], columnas[0], generacion_local ? "local" : "raiz", semilla);
+
+        if (N <= N_MAX_IMPRESION) {
+            imprimir_matriz("Matriz A:", A, N);
+            imprimir_matriz("Matriz B:", B, N);
+            imprimir_matriz("Matriz C = A + B:", C, N);
         }
 
-        printf("\nTiempo de clculo: %f segundos\n", t2 - t1);
+        // Suma de control ponderada por posicin (por filas), comparable entre ejecuciones
+        unsigned long long control = 0;
+        for (size_t i = 0; i < (size_t)N * N; i++) {
+            control += (unsigned long long)C[i] * (i + 1);
+        }
+        printf("\nSuma de control de C: %llu\n", control);
+        printf("Tiempo de clculo: %f segundos\n", t2 - t1);
     }
 
-    // Liberar memoria dinmica 2D
-    for (int i = 0; i < N; i++) {
-        free(A[i]);
-        free(B[i]);
-        free(C[i]);
-    }
+    // Liberar memoria dinmica
+    MPI_Type_free(&tipo_columna);
+    MPI_Type_free(&tipo_columna_local);
     free(A);
     free(B);
     free(C);
@@ -124,8 +194,9 @@ int main(int argc, char* argv[])
     free(colA);
     free(colB);
     free(colC);
+    free(columnas);
+    free(desplazamientos);
 
     MPI_Finalize();
     return 0;
 }
-
@@ -1,123 +1,540 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "kernels_simd.h"
+#include "salida.h"
+
+// Vectores de hasta este tamao se muestran por consola
+#define N_MAX_IMPRESION 20
+// Resultados de hasta este nmero de vectores Y se muestran uno a uno
+#define VECTORES_MAX_IMPRESION 10
+
+// Parmetros por defecto del benchmark de solapamiento (modo 'solape')
+#define SOLAPE_N_MIN 10000LL
+#define SOLAPE_N_MAX 10000000LL
+#define SOLAPE_FRAGMENTOS_MAX 16
+#define SOLAPE_REPETICIONES 5
+
+// Reparto equilibrado de n elementos entre numprocs procesos: los primeros
+// n % numprocs procesos se llevan un elemento ms
+void calcular_bloque(long long n, int numprocs, int rango, long long* inicio, long long* cantidad)
+{
+    long long base = n / numprocs;
+    long long resto = n % numprocs;
+    *cantidad = base + (rango < resto ? 1 : 0);
+    *inicio = rango * base + (rango < resto ? rango : resto);
+}
+
+/*
+   Los vectores son X_i = 1 + (i mod m) e Y_v = X + v, con el periodo
+   m = INT_MAX - (vectores - 1) para que ningn Y_v se salga de un int. Hasta
+   n = m coinciden con X = [1, 2, ..., n]; ms all los valores vuelven a
+   empezar en 1 en lugar de desbordar.
+*/
+long long periodo_valores(int vectores)
+{
+    return (long long)INT_MAX - (vectores - 1);
+}
+
+inline int valor_x(long long i, long long periodo)
+{
+    return (int)(1 + i % periodo);
+}
+
+// Valor exacto de X  Y_v = sum(x_i^2) + v * sum(x_i). Con n = q*m + r son q
+// periodos completos 1..m ms el tramo 1..r, y cada tramo tiene forma cerrada
+void sumas_esperadas(long long n, long long periodo, double* suma_simple, double* suma_cuadrados)
+{
+    double q = (double)(n / periodo), m = (double)periodo, r = (double)(n % periodo);
+    *suma_simple = q * m * (m + 1.0) / 2.0 + r * (r + 1.0) / 2.0;
+    *suma_cuadrados = q * m * (m + 1.0) * (2.0 * m + 1.0) / 6.0 + r * (r + 1.0) * (2.0 * r + 1.0) / 6.0;
+}
+
+// Suma compensada de Kahan-Neumaier de los productos x_i * y_i en doble precisin.
+// 'suma' y 'compensacion' se devuelven por separado para poder reducirlos entre
+// procesos sin perder la correccin
+void producto_kahan(const int* x, const int* y, long long n, double* suma, double* compensacion)
+{
+    double s = 0.0, c = 0.0;
+    for (long long i = 0; i < n; i++) {
+        double termino = (double)x[i] * (double)y[i];
+        double t = s + termino;
+        if (fabs(s) >= fabs(termino)) {
+            c += (s - t) + termino;
+        }
+        else {
+            c += (termino - t) + s;
+        }
+        s = t;
+    }
+    *suma = s;
+    *compensacion = c;
+}
+
+/*
+   Productos parciales de X con cada uno de los 'vectores' vectores Y sobre los
+   elementos [ini, fin) del bloque local. Los Y_v se guardan uno tras otro en
+   'y', cada uno con 'cantidad' elementos. Con Kahan cada vector aporta dos
+   doubles (suma y compensacin); con int64, un long long
+*/
+void productos_fragmento(const int* x, const int* y, long long cantidad, int vectores,
+    long long ini, long long fin, int acumulador_int64, double* parcial, long long* parcial_entero)
+{
+    for (int v = 0; v < vectores; v++) {
+        const int* yv = y + (size_t)v * cantidad;
+        if (acumulador_int64) {
+            parcial_entero[v] = simd_producto(x + ini, yv + ini, (size_t)(fin - ini));
+        }
+        else {
+            producto_kahan(x + ini, yv + ini, fin - ini, &parcial[2 * v], &parcial[2 * v + 1]);
+        }
+    }
+}
+
+/*
+   Producto escalar por tramos: el bloque local se divide en 'fragmentos'
+   tramos y, en cuanto se termina uno, se lanza MPI_Iallreduce con sus
+   parciales mientras se calcula el siguiente. Todos los vectores Y de un
+   tramo viajan en la misma operacin colectiva.
+   Devuelve en 'local' la suma del bloque propio, en 'total' la global y en
+   'tiempo_espera' lo que se tarda en el MPI_Waitall final, es decir, la parte
+   de la reduccin que no ha quedado oculta tras el clculo
+*/
+void producto_solapado(const int* x, const int* y, long long cantidad, int vectores, int fragmentos,
+    int acumulador_int64, double* local, long long* local_entero,
+    double* total, long long* total_entero, double* tiempo_espera)
+{
+    int por_fragmento = acumulador_int64 ? vectores : 2 * vectores;
+    size_t valores = (size_t)fragmentos * por_fragmento;
+    double* parciales = (double*)malloc(valores * sizeof(double));
+    double* reducidos = (double*)malloc(valores * sizeof(double));
+    long long* parciales_enteros = (long long*)malloc(valores * sizeof(long long));
+    long long* reducidos_enteros = (long long*)malloc(valores * sizeof(long long));
+    MPI_Request* peticiones = (MPI_Request*)malloc(fragmentos * sizeof(MPI_Request));
+    if (parciales == NULL || reducidos == NULL || parciales_enteros == NULL ||
+        reducidos_enteros == NULL || peticiones == NULL) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para %d fragmentos.\n", fragmentos);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int k = 0; k < fragmentos; k++) {
+        long long ini, cant;
+        calcular_bloque(cantidad, fragmentos, k, &ini, &cant);
+        size_t desplazamiento = (size_t)k * por_fragmento;
+        productos_fragmento(x, y, cantidad, vectores, ini, ini + cant, acumulador_int64,
+            parciales + desplazamiento, parciales_enteros + desplazamiento);
+        if (acumulador_int64) {
+            MPI_Iallreduce(parciales_enteros + desplazamiento, reducidos_enteros + desplazamiento,
+                por_fragmento, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &peticiones[k]);
+        }
+        else {
+            MPI_Iallreduce(parciales + desplazamiento, reducidos + desplazamiento,
+                por_fragmento, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, &peticiones[k]);
+        }
+        // Muchas implementaciones solo avanzan las operaciones pendientes
+        // cuando se entra en la biblioteca: un MPI_Testall entre tramos basta
+        int completadas;
+        MPI_Testall(k + 1, peticiones, &completadas, MPI_STATUSES_IGNORE);
+    }
+
+    double espera_inicio = MPI_Wtime();
+    MPI_Waitall(fragmentos, peticiones, MPI_STATUSES_IGNORE);
+    *tiempo_espera = MPI_Wtime() - espera_inicio;
+
+    // Combinar los tramos: para Kahan se suman por separado sumas y compensaciones
+    for (int v = 0; v < vectores; v++) {
+        if (acumulador_int64) {
+            local_entero[v] = total_entero[v] = 0;
+            for (int k = 0; k < fragmentos; k++) {
+                local_entero[v] += parciales_enteros[(size_t)k * por_fragmento + v];
+                total_entero[v] += reducidos_enteros[(size_t)k * por_fragmento + v];
+            }
+            local[v] = (double)local_entero[v];
+            total[v] = (double)total_entero[v];
+        }
+        else {
+            double suma_local = 0.0, comp_local = 0.0, suma = 0.0, comp = 0.0;
+            for (int k = 0; k < fragmentos; k++) {
+                size_t d = (size_t)k * por_fragmento + 2 * v;
+                suma_local += parciales[d];
+                comp_local += parciales[d + 1];
+                suma += reducidos[d];
+                comp += reducidos[d + 1];
+            }
+            local[v] = suma_local + comp_local;
+            total[v] = suma + comp;
+        }
+    }
+
+    free(parciales);
+    free(reducidos);
+    free(parciales_enteros);
+    free(reducidos_enteros);
+    free(peticiones);
+}
+
+// Mximo entre procesos de un tiempo local: manda el proceso ms lento
+double tiempo_maximo(double t)
+{
+    double maximo;
+    MPI_Allreduce(&t, &maximo, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return maximo;
+}
+
+/*
+   Benchmark de solapamiento: para cada longitud n (x10 desde SOLAPE_N_MIN) y
+   cada nmero de tramos K (potencias de 2), mide con el acumulador Kahan
+   - calculo: el producto del bloque local sin comunicacin
+   - lote: un MPI_Allreduce bloqueante con los 'vectores' resultados juntos
+   - separada: 'vectores' MPI_Allreduce bloqueantes, uno por resultado
+   - solapado: el producto por tramos con MPI_Iallreduce
+   expuesto es la espera del MPI_Waitall final, la parte de la reduccin que no
+   se ha podido ocultar; oculto es el porcentaje de las K reducciones (K * lote)
+   que s queda tapado por el clculo.
+   Todos los tiempos son el mximo entre procesos y el mejor de las repeticiones.
+   Uso: mpiexec -n P "Practica 3.exe" solape [n_max] [K_max] [vectores] [repeticiones]
+*/
+void benchmark_solape(int mirango, int numprocs, long long n_max, int k_max, int vectores, int repeticiones)
+{
+    double* parcial = (double*)malloc(2 * (size_t)vectores * sizeof(double));
+    double* reducido = (double*)malloc(2 * (size_t)vectores * sizeof(double));
+    long long* enteros = (long long*)malloc(2 * (size_t)vectores * sizeof(long long));
+    double* local = (double*)malloc((size_t)vectores * sizeof(double));
+    double* total = (double*)malloc((size_t)vectores * sizeof(double));
+    if (parcial == NULL || reducido == NULL || enteros == NULL || local == NULL || total == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (mirango == 0) {
+        printf("# Solapamiento de MPI_Iallreduce con el calculo: %d procesos, %d vectores Y, mejor de %d\n",
+            numprocs, vectores, repeticiones);
+        printf("n,K,calculo_us,lote_us,separada_us,solapado_us,expuesto_us,oculto_pct\n");
+        fflush(stdout);
+    }
+
+    for (long long n = SOLAPE_N_MIN; n <= n_max; n *= 10) {
+        long long inicio, cantidad;
+        calcular_bloque(n, numprocs, mirango, &inicio, &cantidad);
+        int* x = (int*)malloc((size_t)(cantidad > 0 ? cantidad : 1) * sizeof(int));
+        int* y = (int*)malloc((size_t)(cantidad > 0 ? cantidad : 1) * vectores * sizeof(int));
+        if (x == NULL || y == NULL) {
+            fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para n = %lld.\n", mirango, n);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        long long periodo = periodo_valores(vectores);
+        for (long long i = 0; i < cantidad; i++) {
+            x[i] = valor_x(inicio + i, periodo);
+            for (int v = 0; v < vectores; v++) {
+                y[(size_t)v * cantidad + i] = x[i] + v;
+            }
+        }
+
+        // Referencias sin solapamiento, comunes a todos los K
+        double calculo = 1e30, lote = 1e30, separada = 1e30;
+        for (int r = 0; r < repeticiones; r++) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            double t = MPI_Wtime();
+            productos_fragmento(x, y, cantidad, vectores, 0, cantidad, 0, parcial, enteros);
+            t = tiempo_maximo(MPI_Wtime() - t);
+            if (t < calculo) calculo = t;
+
+            MPI_Barrier(MPI_COMM_WORLD);
+            t = MPI_Wtime();
+            MPI_Allreduce(parcial, reducido, 2 * vectores, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            t = tiempo_maximo(MPI_Wtime() - t);
+            if (t < lote) lote = t;
+
+            MPI_Barrier(MPI_COMM_WORLD);
+            t = MPI_Wtime();
+            for (int v = 0; v < vectores; v++) {
+                MPI_Allreduce(parcial + 2 * v, reducido + 2 * v, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            }
+            t = tiempo_maximo(MPI_Wtime() - t);
+            if (t < separada) separada = t;
+        }
+
+        for (int k = 1; k <= k_max; k *= 2) {
+            double solapado = 1e30, expuesto = 1e30;
+            for (int r = 0; r < repeticiones; r++) {
+                double espera;
+                MPI_Barrier(MPI_COMM_WORLD);
+                double t = MPI_Wtime();
+                producto_solapado(x, y, cantidad, vectores, k, 0, local, enteros, total, enteros, &espera);
+                t = tiempo_maximo(MPI_Wtime() - t);
+                espera = tiempo_maximo(espera);
+                if (t < solapado) solapado = t;
+                if (espera < expuesto) expuesto = espera;
+            }
+            if (mirango == 0) {
+                double oculto = 100.0 * (1.0 - expuesto / (k * lote));
+                if (oculto < 0.0) oculto = 0.0;
+                printf("%lld,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f\n", n, k, calculo * 1e6, lote * 1e6,
+                    separada * 1e6, solapado * 1e6, expuesto * 1e6, oculto);
+                fflush(stdout);
+            }
+        }
+        free(x);
+        free(y);
+    }
+
+    free(parcial);
+    free(reducido);
+    free(enteros);
+    free(local);
+    free(total);
+}
 
 int main(int argc, char* argv[]) {
     int mirango, numprocs;
-    int n;  // Tamao de los vectores
-    int* vector_x = NULL;  // Vector X completo (solo en proceso 0)
-    int* vector_y = NULL;  // Vector Y completo (solo en proceso 0)
-    int elemento_x;        // Elemento local de X para cada proceso
-    int elemento_y;        // Elemento local de Y para cada proceso
-    int producto_parcial;  // Producto local: elemento_x * elemento_y
-    int producto_escalar;  // Resultado final del producto escalar
-    double tiempo_inicio, tiempo_fin;
+    long long n;           // Tamao de los vectores
+    int* vector_x = NULL;  // Vector X completo (solo en proceso 0, modo scatter)
+    int* vector_y = NULL;  // Vector Y completo (solo en proceso 0, modo scatter)
+    int* bloque_x;         // Bloque local de X para cada proceso
+    int* bloque_y;         // Bloque local de Y para cada proceso
+    double tiempo_inicio, tiempo_calculo, tiempo_fin;
     // Inicializar MPI
     MPI_Init(&argc, &argv);
     MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
     MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
 
-    // El proceso 0 inicializa los vectores y solicita el tamao
+    if (argc > 1 && strcmp(argv[1], "solape") == 0) {
+        long long n_max = argc > 2 ? atoll(argv[2]) : SOLAPE_N_MAX;
+        int k_max = argc > 3 ? atoi(argv[3]) : SOLAPE_FRAGMENTOS_MAX;
+        int vectores = argc > 4 ? atoi(argv[4]) : 1;
+        int repeticiones = argc > 5 ? atoi(argv[5]) : SOLAPE_REPETICIONES;
+        benchmark_solape(mirango, numprocs, n_max, k_max > 0 ? k_max : 1,
+            vectores > 0 ? vectores : 1, repeticiones > 0 ? repeticiones : 1);
+        MPI_Finalize();
+        return 0;
+    }
+
+    /*
+       Argumentos (todos opcionales):
+       - n: tamao de los vectores (si falta se pide por teclado)
+       - generacion: scatter (el proceso 0 crea los vectores y los reparte con
+         MPI_Scatterv) o local (cada proceso genera su bloque; necesario para
+         vectores de ms de INT_MAX elementos)
+       - acumulador: kahan (suma compensada en double) o int64 (entero de 64
+         bits, exacto mientras el resultado quepa)
+       - fragmentos: nmero K de tramos en que se divide cada bloque; con K > 1
+         la reduccin de cada tramo se solapa con el clculo del siguiente
+       - vectores: nmero V de vectores Y_v = X + v con los que se multiplica X;
+         los V resultados se reducen juntos en una sola operacin colectiva
+       X = [1, 2, ..., n] mientras n <= INT_MAX - (V - 1); para n mayores los
+       valores vuelven a empezar en 1 (ver periodo_valores)
+    */
+    // Detalle de la salida: MPI_VERBOSIDAD=0 deja solo el resumen del proceso 0
+    SalidaOrdenada salida;
+    salida_iniciar(&salida, MPI_COMM_WORLD, SALIDA_ELEMENTOS);
+
+    int generacion_local = argc > 2 && strcmp(argv[2], "local") == 0;
+    int acumulador_int64 = argc > 3 && strcmp(argv[3], "int64") == 0;
+    int fragmentos = argc > 4 ? atoi(argv[4]) : 1;
+    int vectores = argc > 5 ? atoi(argv[5]) : 1;
+    if (fragmentos < 1) fragmentos = 1;
+    if (vectores < 1) vectores = 1;
+
+    // El proceso 0 solicita el tamao
     if (mirango == 0) {
         printf("  PRODUCTO ESCALAR DE VECTORES CON MPI\n");
         printf("Numero de procesos: %d\n", numprocs);
         fflush(stdout);
-        // Bucle de validacin: repetir hasta que el usuario introduzca el tamao correcto
-        int tamao_valido = 0;
-        while (!tamao_valido) {
-            printf("Introduce el tamao de los vectores (debe ser %d): ", numprocs);
+        n = argc > 1 ? atoll(argv[1]) : 0;
+        // Bucle de validacin: repetir hasta que el usuario introduzca un tamao correcto
+        while (n <= 0) {
+            printf("Introduce el tamao de los vectores: ");
             fflush(stdout);
 
             // Verificar que la entrada sea un nmero vlido
-            if (scanf_s("%d", &n) != 1) {
+            if (scanf_s("%lld", &n) != 1) {
                 // Limpiar el buffer en caso de entrada no numrica
                 while (getchar() != '\n');
                 printf("\nERROR: Debes introducir un numero entero.\n");
+                n = 0;
                 continue;
             }
-            // Validar que el tamao coincida con el nmero de procesos
-            if (n != numprocs) {
-                printf("\nERROR: El tamao debe ser %d (numero de procesos disponibles).\n", numprocs);
-                printf("Has introducido: %d. Intentalo de nuevo.\n\n", n);
-            }
-            else if (n <= 0) {
+            if (n <= 0) {
                 printf("\nERROR: El tamao debe ser un numero positivo.\n\n");
             }
-            else {
-                tamao_valido = 1;  // Tamao correcto, salir del bucle
-            }
         }
-        // Reservar memoria para los vectores completos
-        vector_x = (int*)malloc(n * sizeof(int));
-        vector_y = (int*)malloc(n * sizeof(int));
-
-        // Inicializar los vectores con valores
-        printf("\nInicializando vectores...\n");
-        printf("Vector X: [ ");
-        for (int i = 0; i < n; i++) {
-            vector_x[i] = i + 1;  // X = [1, 2, 3, ..., n]
-            printf("%d ", vector_x[i]);
+        // MPI_Scatterv usa desplazamientos int: ms all hay que generar en local
+        if (!generacion_local && n > INT_MAX) {
+            printf("AVISO: n > %d no se puede repartir con MPI_Scatterv, se genera en local.\n", INT_MAX);
         }
-        printf("]\n");
-
-        printf("Vector Y: [ ");
-        for (int i = 0; i < n; i++) {
-            vector_y[i] = i + 1;  // Y = [1, 2, 3, ..., n]
-            printf("%d ", vector_y[i]);
-        }
-        printf("]\n\n");
-        // Iniciar medicin de tiempo
-        tiempo_inicio = MPI_Wtime();
     }
     // Broadcast del tamao de los vectores a todos los procesos
-    MPI_Bcast(&n, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    // Distribuir un elemento de cada vector a cada proceso usando MPI_Scatter
-    // Proceso 0 reparte los elementos: el elemento i va al proceso de rango i
-    MPI_Scatter(vector_x,1,MPI_INT,&elemento_x,1,MPI_INT,0,MPI_COMM_WORLD);
-    MPI_Scatter(vector_y,1,MPI_INT,&elemento_y,1,MPI_INT,0,MPI_COMM_WORLD);
-    // Cada proceso calcula su producto parcial: x_i * y_i
-    producto_parcial = elemento_x * elemento_y;
-
-    // Sincronizar antes de imprimir los clculos parciales
+    MPI_Bcast(&n, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    if (n > INT_MAX) {
+        generacion_local = 1;
+    }
+
+    // Cada proceso trabaja sobre un bloque contiguo de elementos
+    long long inicio, cantidad;
+    calcular_bloque(n, numprocs, mirango, &inicio, &cantidad);
+    bloque_x = (int*)malloc((size_t)(cantidad > 0 ? cantidad : 1) * sizeof(int));
+    bloque_y = (int*)malloc((size_t)(cantidad > 0 ? cantidad : 1) * vectores * sizeof(int));
+    if (bloque_x == NULL || bloque_y == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para %lld elementos.\n",
+            mirango, cantidad);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
     MPI_Barrier(MPI_COMM_WORLD);
+    // Iniciar medicin de tiempo
+    tiempo_inicio = MPI_Wtime();
 
-    // Imprimir los clculos de forma ordenada por rango
-    for (int i = 0; i < numprocs; i++) {
-        if (mirango == i) {
-            printf("[Proceso %d] Calculando: %d * %d = %d\n",
-                mirango, elemento_x, elemento_y, producto_parcial);
-            fflush(stdout);
+    long long periodo = periodo_valores(vectores);
+    if (generacion_local) {
+        // X_i = 1 + (i mod m) e Y_v = X + v: cada proceso rellena su tramo
+        for (long long i = 0; i < cantidad; i++) {
+            bloque_x[i] = valor_x(inicio + i, periodo);
+            for (int v = 0; v < vectores; v++) {
+                bloque_y[(size_t)v * cantidad + i] = bloque_x[i] + v;
+            }
+        }
+    }
+    else {
+        int* cantidades = NULL;
+        int* desplazamientos = NULL;
+        if (mirango == 0) {
+            // Reservar memoria para los vectores completos
+            vector_x = (int*)malloc((size_t)n * sizeof(int));
+            vector_y = (int*)malloc((size_t)n * sizeof(int));
+            cantidades = (int*)malloc(numprocs * sizeof(int));
+            desplazamientos = (int*)malloc(numprocs * sizeof(int));
+            if (vector_x == NULL || vector_y == NULL || cantidades == NULL || desplazamientos == NULL) {
+                fprintf(stderr, "ERROR: No se pudo asignar memoria para los vectores completos.\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            for (long long i = 0; i < n; i++) {
+                vector_x[i] = valor_x(i, periodo);  // X = [1, 2, 3, ..., n]
+            }
+            for (int p = 0; p < numprocs; p++) {
+                long long ini, cant;
+                calcular_bloque(n, numprocs, p, &ini, &cant);
+                cantidades[p] = (int)cant;
+                desplazamientos[p] = (int)ini;
+            }
         }
-        MPI_Barrier(MPI_COMM_WORLD);
+        // Distribuir a cada proceso su bloque de cada vector
+        MPI_Scatterv(vector_x, cantidades, desplazamientos, MPI_INT,
+            bloque_x, (int)cantidad, MPI_INT, 0, MPI_COMM_WORLD);
+        // Cada Y_v se genera en el proceso 0 reutilizando el mismo bfer
+        for (int v = 0; v < vectores; v++) {
+            if (mirango == 0) {
+                for (long long i = 0; i < n; i++) {
+                    vector_y[i] = vector_x[i] + v;  // Y_v = [1+v, 2+v, ..., n+v]
+                }
+            }
+            MPI_Scatterv(vector_y, cantidades, desplazamientos, MPI_INT,
+                bloque_y + (size_t)v * cantidad, (int)cantidad, MPI_INT, 0, MPI_COMM_WORLD);
+        }
+        free(cantidades);
+        free(desplazamientos);
     }
 
-    // Esperar a que todos terminen de imprimir
-    if (mirango == 0) {
+    if (mirango == 0 && n <= N_MAX_IMPRESION && salida_activa(&salida, SALIDA_ELEMENTOS)) {
+        printf("\nVector X = Vector Y_0 = [ ");
+        for (long long i = 0; i < n; i++) {
+            printf("%lld ", i + 1);
+        }
+        printf("]\n");
+        if (vectores > 1) {
+            printf("Vectores Y_v = X + v, v = 0..%d\n", vectores - 1);
+        }
         printf("\n");
         fflush(stdout);
     }
-    MPI_Barrier(MPI_COMM_WORLD);
 
-    // Reducir todos los productos parciales sumndolos en el proceso 0
-    // Esto implementa: producto_escalar = sum(x_i * y_i) para i = 0 hasta n-1
-    MPI_Reduce(&producto_parcial,&producto_escalar,1,MPI_INT,MPI_SUM,0,MPI_COMM_WORLD);
+    // Cada proceso calcula sus productos parciales por tramos y los reduce con
+    // MPI_Iallreduce; con un solo tramo no hay nada con lo que solapar
+    //  - int64: ncleo SIMD con acumulacin entera de 64 bits
+    //  - kahan: suma compensada en double, sin desbordamiento
+    double* parcial = (double*)malloc(vectores * sizeof(double));
+    double* producto_escalar = (double*)malloc(vectores * sizeof(double));
+    long long* parcial_entero = (long long*)malloc(vectores * sizeof(long long));
+    long long* producto_entero = (long long*)malloc(vectores * sizeof(long long));
+    if (parcial == NULL || producto_escalar == NULL || parcial_entero == NULL || producto_entero == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para %d resultados.\n",
+            mirango, vectores);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    double calculo_inicio = MPI_Wtime();
+    double tiempo_espera;
+    producto_solapado(bloque_x, bloque_y, cantidad, vectores, fragmentos, acumulador_int64,
+        parcial, parcial_entero, producto_escalar, producto_entero, &tiempo_espera);
+    tiempo_calculo = MPI_Wtime();
+    // Lo que tarda el proceso ms lento en esperar la reduccin pendiente
+    double espera_maxima;
+    MPI_Reduce(&tiempo_espera, &espera_maxima, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Imprimir los clculos de forma ordenada por rango (producto con Y_0)
+    if (acumulador_int64) {
+        salida_printf(&salida, SALIDA_PROCESOS, "[Proceso %d] Elementos [%lld, %lld): suma parcial = %lld\n",
+            mirango, inicio, inicio + cantidad, parcial_entero[0]);
+    }
+    else {
+        salida_printf(&salida, SALIDA_PROCESOS, "[Proceso %d] Elementos [%lld, %lld): suma parcial = %.17g\n",
+            mirango, inicio, inicio + cantidad, parcial[0]);
+    }
+    salida_volcar(&salida, stdout);
 
     // El proceso 0 muestra el resultado final
     if (mirango == 0) {
         // Finalizar medicin de tiempo
         tiempo_fin = MPI_Wtime();
 
+        // Valor exacto de X  Y_v; hasta n = m es n(n+1)(2n+1)/6 + v * n(n+1)/2
+        double suma_simple, suma_cuadrados;
+        sumas_esperadas(n, periodo, &suma_simple, &suma_cuadrados);
+        double error_maximo = 0.0;
+        for (int v = 0; v < vectores; v++) {
+            double esperado = suma_cuadrados + v * suma_simple;
+            double error_relativo = fabs(producto_escalar[v] - esperado) / esperado;
+            if (error_relativo > error_maximo) error_maximo = error_relativo;
+        }
+
         printf("\n========================================\n");
         printf("RESULTADO:\n");
         printf("========================================\n");
-        printf("Producto escalar (X  Y) = %d\n", producto_escalar);
+        for (int v = 0; v < vectores && v < VECTORES_MAX_IMPRESION; v++) {
+            if (acumulador_int64) {
+                printf("Producto escalar (X  Y_%d) = %lld (acumulador int64)\n", v, producto_entero[v]);
+            }
+            else {
+                printf("Producto escalar (X  Y_%d) = %.17g (acumulador Kahan)\n", v, producto_escalar[v]);
+            }
+        }
+        if (vectores > VECTORES_MAX_IMPRESION) {
+            printf("... (%d vectores en total)\n", vectores);
+        }
+        printf("Valor esperado (X  Y_0) = %.17g\n", suma_cuadrados);
+        printf("Error relativo maximo: %.3e%s\n", error_maximo,
+            error_maximo > 1e-6 ? "  <-- DESBORDAMIENTO: usar el acumulador kahan" : "");
+        printf("Elementos: %lld en %d procesos, generacion %s\n",
+            n, numprocs, generacion_local ? "local" : "scatter");
+        printf("Tramos por bloque: %d, vectores por reduccion: %d\n", fragmentos, vectores);
+        printf("Tiempo de reparto: %.6f segundos\n", calculo_inicio - tiempo_inicio);
+        printf("Tiempo de calculo y reduccion: %.6f segundos\n", tiempo_calculo - calculo_inicio);
+        printf("Espera final de la reduccion (no solapada): %.6f segundos\n", espera_maxima);
         printf("Tiempo de ejecucion: %.6f segundos\n", tiempo_fin - tiempo_inicio);
         printf("========================================\n");
-
-        // Liberar memoria
-        free(vector_x);
-        free(vector_y);
     }
+
+    // Liberar memoria
+    free(vector_x);
+    free(vector_y);
+    free(bloque_x);
+    free(bloque_y);
+    free(parcial);
+    free(producto_escalar);
+    free(parcial_entero);
+    free(producto_entero);
+    salida_liberar(&salida);
     // Finalizar MPI
     MPI_Finalize();
     return 0;
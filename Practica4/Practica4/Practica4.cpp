@@ -9,43 +9,1400 @@
   DESCRIPCIÓN:
   Este programa realiza la suma de dos matrices M×N utilizando una topología
   cartesiana virtual en MPI. Cada proceso de la topología se encarga de sumar
-  un elemento específico de las dos matrices según sus coordenadas cartesianas.
+  un bloque rectangular (tesela) de las dos matrices según sus coordenadas
+  cartesianas.
 
   TOPOLOGÍA:
-  - Se crea una topología cartesiana 2D (filas × columnas)
+  - Se crea una topología cartesiana 2D pr × pc con todos los procesos,
+    independiente del tamaño de las matrices
+  - La malla se elige automáticamente entre todas las factorizaciones de P
+    (completadas con MPI_Dims_create) minimizando el perímetro de la tesela,
+    que es lo que se comunica en un intercambio de bordes
+  - reorder=1 permite a MPI colocar vecinos de la malla en el mismo nodo
   - Cada proceso tiene coordenadas [fila][columna]
-  - El proceso en coordenadas (i,j) suma: C[i][j] = A[i][j] + B[i][j]
+  - El proceso en coordenadas (i,j) suma la tesela de ceil(M/pr) × ceil(N/pc)
+    elementos que empieza en la fila i·ceil(M/pr) y la columna j·ceil(N/pc)
 
-  REQUISITOS:
-  - El número de procesos debe ser igual a M × N
+  REPARTO:
+  - El proceso 0 guarda las matrices completas con relleno hasta un múltiplo
+    del tamaño de tesela; así todas las teselas tienen la misma forma y basta
+    un único tipo MPI_Type_create_subarray para MPI_Scatterv y MPI_Gatherv
+  - Alternativamente cada proceso genera su tesela localmente
+
+  USO:
+  - mpiexec -n P Practica4.exe [M] [N] [semilla] [raiz|local] [fichero.mat]
+    con fichero, C se guarda en el formato binario de Comun/matriz_binaria.h:
+    cada proceso escribe su tesela directamente en su sitio del fichero
+  - mpiexec -n P Practica4.exe jacobi [M] [N] [iteraciones] [5|9] [fijo|periodico] [semilla] [p2p|vecindad]
+    resuelve la difusión de calor con un esténcil de Jacobi sobre las
+    mismas teselas, intercambiando bordes con los vecinos de MPI_Cart_shift
+    o con MPI_Ineighbor_alltoallw
+  - mpiexec -n P Practica4.exe halo [5|9] [lado_max] [iteraciones]
+    compara los dos métodos de intercambio de bordes
+  - mpiexec -n P Practica4.exe producto [summa|cannon] [M] [N] [K] [semilla]
+    multiplica C = A·B sobre la malla (SUMMA con difusiones por filas y
+    columnas de procesos, o Cannon en mallas cuadradas)
+  - mpiexec -n P Practica4.exe escalado [summa|cannon] [n] [fuerte|debil] [repeticiones]
+  - mpiexec -n P Practica4.exe agregados [M] [N] [semilla]
+    sumas por filas y columnas e y = A·x reduciendo solo a lo largo de una
+    dimensión de la malla (comunicadores de MPI_Cart_sub)
   - Compatible con Visual Studio + DeinoMPI
-  - Usa MPI_Cart_create y MPI_Cart_coords
+  - Usa MPI_Dims_create, MPI_Cart_create y MPI_Cart_coords
 ================================================================================
 */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <time.h>
+#include "aleatorio.h"
+#include "salida.h"
+#include "matriz_binaria.h"
+#include "pistas_es.h"
+
+// Matrices de hasta este tamaño (filas y columnas) se muestran por consola
+#define N_MAX_IMPRESION 12
+
+// Imprime las primeras filas × columnas de una matriz guardada por filas con
+// 'ancho' enteros por fila (el ancho incluye el relleno)
+void imprimir_matriz(const char* titulo, const int* M, int filas, int columnas, int ancho)
+{
+    if (titulo[0] != '\0') {
+        printf("%s\n", titulo);
+    }
+    for (int i = 0; i < filas; i++) {
+        printf("  ");
+        for (int j = 0; j < columnas; j++) {
+            printf("%d ", M[(size_t)i * ancho + j]);
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+// Elementos útiles de la tesela número 'indice' de tamaño 'bloque' en una
+// dimensión de 'total' elementos (las últimas pueden quedar cortas o vacías)
+int elementos_tesela(int total, int bloque, int indice)
+{
+    int restantes = total - indice * bloque;
+    if (restantes < 0) return 0;
+    return restantes < bloque ? restantes : bloque;
+}
+
+/*
+   Elige la malla pr × pc para P procesos y una matriz M × N. Para cada
+   divisor pr de P se fija dims[0] = pr y MPI_Dims_create completa dims[1];
+   gana la malla cuya tesela ceil(M/pr) × ceil(N/pc) tiene menor perímetro y,
+   a igualdad, la que deja menos relleno. Devuelve en 'dims' la malla elegida
+*/
+void elegir_malla(int numprocs, int filas, int columnas, int dims[2])
+{
+    long long mejor_perimetro = -1, mejor_relleno = 0;
+    for (int pr = 1; pr <= numprocs; pr++) {
+        if (numprocs % pr != 0) continue;
+        int candidata[2] = { pr, 0 };
+        MPI_Dims_create(numprocs, 2, candidata);
+        long long bm = (filas + candidata[0] - 1) / candidata[0];
+        long long bn = (columnas + candidata[1] - 1) / candidata[1];
+        long long perimetro = 2 * (bm + bn);
+        long long relleno = bm * candidata[0] * bn * candidata[1] - (long long)filas * columnas;
+        if (mejor_perimetro < 0 || perimetro < mejor_perimetro ||
+            (perimetro == mejor_perimetro && relleno < mejor_relleno)) {
+            mejor_perimetro = perimetro;
+            mejor_relleno = relleno;
+            dims[0] = candidata[0];
+            dims[1] = candidata[1];
+        }
+    }
+}
+
+// Elementos que cruzan fronteras entre teselas en un intercambio de bordes
+// completo (en ambos sentidos): cada corte horizontal mueve una fila de N
+// elementos y cada corte vertical una columna de M
+long long volumen_halo(int filas, int columnas, const int dims[2])
+{
+    return 2LL * ((long long)(dims[0] - 1) * columnas + (long long)(dims[1] - 1) * filas);
+}
+
+// =============================================================================
+// RESOLVEDOR DE JACOBI CON INTERCAMBIO DE BORDES (modo 'jacobi')
+// =============================================================================
+/*
+   Difusión de calor sobre una malla M × N repartida en teselas equilibradas
+   sobre comm_cart. Cada tesela guarda una capa de celdas fantasma alrededor
+   (halo) con los bordes de las teselas vecinas:
+
+       ancho local = columnas + 2, la celda (i, j) está en i·ancho + j,
+       con i en [1, filas] y j en [1, columnas] para los datos propios
+
+   En cada iteración se lanza el intercambio del halo, se actualiza el
+   interior (que no depende del halo) mientras viajan los mensajes y, tras
+   MPI_Waitall, se actualiza el anillo exterior de la tesela. El intercambio
+   puede hacerse con un Irecv/Isend por vecino (p2p) o con una sola
+   MPI_Ineighbor_alltoallw sobre un grafo de vecinos (vecindad).
+   - 5 puntos: u' = (N + S + E + O) / 4
+   - 9 puntos: u' = (4·(N + S + E + O) + NE + NO + SE + SO) / 20; necesita
+     también las esquinas de las teselas diagonales
+   - Contorno fijo: las celdas fantasma del borde global no se reciben de
+     nadie (MPI_PROC_NULL) y conservan su valor: 100 arriba, 0 en el resto
+   - Contorno periódico: la malla de procesos se cierra en las dos dimensiones
+   - Puntos de control: cada 'cada' iteraciones se guarda el campo y el
+     estado (iteración y semilla; el generador depende solo de la semilla y
+     la posición, así que no tiene más estado que guardar) en
+     jacobi_control.0.mat y jacobi_control.1.mat de forma alterna, así que si
+     el programa cae a mitad de una escritura queda intacto el anterior. La
+     escritura es colectiva y asíncrona sobre una copia de la tesela. Con
+     'reanudar' se sigue desde el punto de control válido más reciente,
+     con cualquier número de procesos: cada uno lee su tesela del fichero.
+     Se sigue con la semilla guardada: con semilla 0 (la de por defecto) se
+     toma la del fichero, y cualquier otra distinta de la guardada es un error
+   Uso: mpiexec -n P Practica4.exe jacobi [M] [N] [iteraciones] [5|9] [fijo|periodico] [semilla] [p2p|vecindad]
+        [cada] [reanudar]
+*/
+#define JACOBI_N_DEFECTO 1024
+#define JACOBI_ITERACIONES 100
+#define JACOBI_TEMPERATURA_BORDE 100.0
+#define CONTROL_FICHERO "jacobi_control"
+#define CONTROL_MAGIA "JACOBI02"
+
+// Las 8 direcciones de vecinos (fila, columna): las 4 primeras bastan para
+// el esténcil de 5 puntos
+static const int DIRECCIONES[8][2] = {
+    { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 },
+    { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 }
+};
+
+// Índice de la dirección opuesta (para las etiquetas de los mensajes)
+int direccion_opuesta(int d)
+{
+    for (int k = 0; k < 8; k++) {
+        if (DIRECCIONES[k][0] == -DIRECCIONES[d][0] && DIRECCIONES[k][1] == -DIRECCIONES[d][1]) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// Reparto equilibrado de 'total' elementos en 'partes': los primeros
+// total % partes trozos se llevan un elemento más
+void calcular_bloque(int total, int partes, int indice, int* inicio, int* cantidad)
+{
+    int base = total / partes;
+    int resto = total % partes;
+    *cantidad = base + (indice < resto ? 1 : 0);
+    *inicio = indice * base + (indice < resto ? indice : resto);
+}
+
+typedef struct {
+    MPI_Comm comm;
+    int filas, columnas, ancho;     // Tesela propia y ancho con halo
+    int direcciones;                // 4 (5 puntos) u 8 (9 puntos)
+    int vecinos[8];                 // Rango del vecino en cada dirección o MPI_PROC_NULL
+    MPI_Datatype tipo_columna;      // 'filas' doubles separados 'ancho'
+
+    // Intercambio con colectiva de vecindad (solo si vecindad = 1)
+    int vecindad;
+    MPI_Comm comm_vecindad;         // Grafo distribuido con los vecinos reales
+    int grado_origen, grado_destino;
+    int contadores_origen[8], contadores_destino[8];
+    MPI_Aint desplazamientos[8];    // Todos 0: la posición la da el tipo subarray
+    MPI_Datatype tipos_origen[8], tipos_destino[8];
+} Halo;
+
+/*
+   Fila y columna locales donde empieza la región que se envía hacia la
+   dirección d (enviar = 1) o la zona del halo donde se recibe lo que llega
+   desde d (enviar = 0)
+*/
+void halo_origen(const Halo* h, int d, int enviar, int* fila, int* columna)
+{
+    int di = DIRECCIONES[d][0], dj = DIRECCIONES[d][1];
+    *fila = di < 0 ? (enviar ? 1 : 0) : (di > 0 ? (enviar ? h->filas : h->filas + 1) : 1);
+    *columna = dj < 0 ? (enviar ? 1 : 0) : (dj > 0 ? (enviar ? h->columnas : h->columnas + 1) : 1);
+}
+
+// La misma región como subarray de la tesela con halo (filas + 2) × ancho
+MPI_Datatype halo_subarray(const Halo* h, int d, int enviar)
+{
+    int tamanos[2] = { h->filas + 2, h->ancho };
+    int subtamanos[2] = { DIRECCIONES[d][0] == 0 ? h->filas : 1, DIRECCIONES[d][1] == 0 ? h->columnas : 1 };
+    int inicio[2];
+    MPI_Datatype tipo;
+    halo_origen(h, d, enviar, &inicio[0], &inicio[1]);
+    MPI_Type_create_subarray(2, tamanos, subtamanos, inicio, MPI_ORDER_C, MPI_DOUBLE, &tipo);
+    MPI_Type_commit(&tipo);
+    return tipo;
+}
+
+/*
+   Prepara el intercambio de bordes: vecinos en las 4 direcciones con
+   MPI_Cart_shift y, para 9 puntos, los diagonales con MPI_Cart_rank (que ya
+   aplica la periodicidad de cada dimensión).
+   Con 'vecindad' se crea además un grafo distribuido con las aristas
+   destino[i] = vecino(d_i) y origen[i] = vecino(-d_i), recorriendo las
+   direcciones en el mismo orden en todos los procesos y quitando los
+   MPI_PROC_NULL. Así, aunque un mismo proceso sea vecino en varias
+   direcciones (mallas periódicas de 1 o 2 procesos), el k-ésimo envío de A
+   a B casa con la k-ésima recepción de B desde A.
+*/
+void halo_iniciar(Halo* h, MPI_Comm comm, int filas, int columnas, int nueve_puntos, int vecindad)
+{
+    int dims[2], periodos[2], coords[2];
+    MPI_Cart_get(comm, 2, dims, periodos, coords);
+    h->comm = comm;
+    h->filas = filas;
+    h->columnas = columnas;
+    h->ancho = columnas + 2;
+    h->direcciones = nueve_puntos ? 8 : 4;
+
+    MPI_Cart_shift(comm, 0, 1, &h->vecinos[0], &h->vecinos[1]);
+    MPI_Cart_shift(comm, 1, 1, &h->vecinos[2], &h->vecinos[3]);
+    for (int d = 4; d < 8; d++) {
+        int c[2] = { coords[0] + DIRECCIONES[d][0], coords[1] + DIRECCIONES[d][1] };
+        int dentro = 1;
+        for (int k = 0; k < 2; k++) {
+            if (!periodos[k] && (c[k] < 0 || c[k] >= dims[k])) dentro = 0;
+        }
+        h->vecinos[d] = MPI_PROC_NULL;
+        if (dentro) {
+            MPI_Cart_rank(comm, c, &h->vecinos[d]);
+        }
+    }
+
+    MPI_Type_vector(filas, 1, h->ancho, MPI_DOUBLE, &h->tipo_columna);
+    MPI_Type_commit(&h->tipo_columna);
+
+    h->vecindad = vecindad;
+    h->comm_vecindad = MPI_COMM_NULL;
+    h->grado_origen = h->grado_destino = 0;
+    if (vecindad) {
+        int origenes[8], destinos[8];
+        for (int d = 0; d < h->direcciones; d++) {
+            int opuesta = direccion_opuesta(d);
+            if (h->vecinos[d] != MPI_PROC_NULL) {
+                destinos[h->grado_destino] = h->vecinos[d];
+                h->tipos_destino[h->grado_destino] = halo_subarray(h, d, 1);
+                h->contadores_destino[h->grado_destino] = 1;
+                h->grado_destino++;
+            }
+            if (h->vecinos[opuesta] != MPI_PROC_NULL) {
+                origenes[h->grado_origen] = h->vecinos[opuesta];
+                h->tipos_origen[h->grado_origen] = halo_subarray(h, opuesta, 0);
+                h->contadores_origen[h->grado_origen] = 1;
+                h->grado_origen++;
+            }
+            h->desplazamientos[d] = 0;
+        }
+        MPI_Dist_graph_create_adjacent(comm, h->grado_origen, origenes, MPI_UNWEIGHTED,
+            h->grado_destino, destinos, MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &h->comm_vecindad);
+    }
+}
+
+void halo_liberar(Halo* h)
+{
+    MPI_Type_free(&h->tipo_columna);
+    for (int k = 0; k < h->grado_origen; k++) MPI_Type_free(&h->tipos_origen[k]);
+    for (int k = 0; k < h->grado_destino; k++) MPI_Type_free(&h->tipos_destino[k]);
+    if (h->comm_vecindad != MPI_COMM_NULL) MPI_Comm_free(&h->comm_vecindad);
+}
+
+/*
+   Región de la tesela que se envía hacia la dirección d (enviar = 1) o la
+   zona del halo donde se recibe lo que llega desde d (enviar = 0):
+   desplazamiento en el array, número de elementos y tipo
+*/
+void halo_region(const Halo* h, int d, int enviar, size_t* desplazamiento, int* cantidad, MPI_Datatype* tipo)
+{
+    int di = DIRECCIONES[d][0], dj = DIRECCIONES[d][1];
+    int fila, columna;
+    halo_origen(h, d, enviar, &fila, &columna);
+    *desplazamiento = (size_t)fila * h->ancho + columna;
+    if (di == 0) {
+        *cantidad = 1;
+        *tipo = h->tipo_columna;
+    }
+    else if (dj == 0) {
+        *cantidad = h->columnas;
+        *tipo = MPI_DOUBLE;
+    }
+    else {
+        *cantidad = 1;
+        *tipo = MPI_DOUBLE;
+    }
+}
+
+// Lanza el intercambio de bordes de 'campo' y devuelve cuántas peticiones deja
+// pendientes: 2·direcciones con p2p, una sola con la colectiva de vecindad
+int halo_lanzar(const Halo* h, double* campo, MPI_Request* peticiones)
+{
+    if (h->vecindad) {
+        // Se lee del borde propio y se escribe en el halo: regiones disjuntas
+        // del mismo array, descritas por los tipos subarray
+        MPI_Ineighbor_alltoallw(campo, h->contadores_destino, h->desplazamientos, h->tipos_destino,
+            campo, h->contadores_origen, h->desplazamientos, h->tipos_origen,
+            h->comm_vecindad, &peticiones[0]);
+        return 1;
+    }
+    for (int d = 0; d < h->direcciones; d++) {
+        size_t desplazamiento;
+        int cantidad;
+        MPI_Datatype tipo;
+        // Lo que llega del vecino en d es lo que él envía hacia la dirección opuesta
+        halo_region(h, d, 0, &desplazamiento, &cantidad, &tipo);
+        MPI_Irecv(campo + desplazamiento, cantidad, tipo, h->vecinos[d], direccion_opuesta(d),
+            h->comm, &peticiones[2 * d]);
+        halo_region(h, d, 1, &desplazamiento, &cantidad, &tipo);
+        MPI_Isend(campo + desplazamiento, cantidad, tipo, h->vecinos[d], d,
+            h->comm, &peticiones[2 * d + 1]);
+    }
+    return 2 * h->direcciones;
+}
+
+/*
+   Actualiza el rectángulo [i0, i1] × [j0, j1] (índices locales, inclusivos)
+   y devuelve el mayor cambio |u' - u| de la región
+*/
+double jacobi_region(const double* u, double* v, int ancho, int i0, int i1, int j0, int j1, int nueve_puntos)
+{
+    double cambio = 0.0;
+    for (int i = i0; i <= i1; i++) {
+        const double* arriba = u + (size_t)(i - 1) * ancho;
+        const double* centro = u + (size_t)i * ancho;
+        const double* abajo = u + (size_t)(i + 1) * ancho;
+        double* destino = v + (size_t)i * ancho;
+        for (int j = j0; j <= j1; j++) {
+            double cruz = arriba[j] + abajo[j] + centro[j - 1] + centro[j + 1];
+            double nuevo;
+            if (nueve_puntos) {
+                double diagonales = arriba[j - 1] + arriba[j + 1] + abajo[j - 1] + abajo[j + 1];
+                nuevo = (4.0 * cruz + diagonales) / 20.0;
+            }
+            else {
+                nuevo = 0.25 * cruz;
+            }
+            double d = fabs(nuevo - centro[j]);
+            if (d > cambio) cambio = d;
+            destino[j] = nuevo;
+        }
+    }
+    return cambio;
+}
+
+// Anillo exterior de la tesela: las celdas que leen del halo
+double jacobi_anillo(const double* u, double* v, int filas, int columnas, int ancho, int nueve_puntos)
+{
+    double cambio = jacobi_region(u, v, ancho, 1, 1, 1, columnas, nueve_puntos);
+    if (filas > 1) {
+        double c = jacobi_region(u, v, ancho, filas, filas, 1, columnas, nueve_puntos);
+        if (c > cambio) cambio = c;
+    }
+    if (filas > 2) {
+        double c = jacobi_region(u, v, ancho, 2, filas - 1, 1, 1, nueve_puntos);
+        if (c > cambio) cambio = c;
+        if (columnas > 1) {
+            c = jacobi_region(u, v, ancho, 2, filas - 1, columnas, columnas, nueve_puntos);
+            if (c > cambio) cambio = c;
+        }
+    }
+    return cambio;
+}
+
+// Estado de la simulación que acompaña al campo en un punto de control
+typedef struct {
+    char magia[8];
+    int64_t iteracion;          // Iteraciones completadas
+    uint64_t semilla;           // Semilla del estado inicial
+    int32_t nueve_puntos;
+    int32_t periodico;
+} EstadoJacobi;
+
+void nombre_control(char* nombre, size_t capacidad, int indice)
+{
+    snprintf(nombre, capacidad, "%s.%d.mat", CONTROL_FICHERO, indice);
+}
+
+/*
+   Busca entre los dos ficheros el punto de control válido más reciente del
+   mismo problema y carga el campo en la tesela. Si el más reciente está
+   incompleto (la suma de control no cuadra) se usa el otro. Devuelve el
+   índice del fichero usado, o -1 si no hay ninguno.
+*/
+int jacobi_reanudar(MPI_Comm comm, MPI_Info pistas, int M, int N, int nueve_puntos, int periodico,
+    double* campo, TeselaMatriz tesela, EstadoJacobi* estado)
+{
+    int mirango;
+    MPI_Comm_rank(comm, &mirango);
+    CabeceraMatriz cabeceras[2];
+    EstadoJacobi estados[2];
+    int validos[2];
+    char nombre[64];
+    for (int f = 0; f < 2; f++) {
+        nombre_control(nombre, sizeof(nombre), f);
+        validos[f] = matriz_leer_cabecera(comm, nombre, &cabeceras[f]) == MATRIZ_OK
+            && matriz_leer_metadatos(comm, nombre, &cabeceras[f], &estados[f], (int)sizeof(EstadoJacobi)) == MATRIZ_OK
+            && memcmp(estados[f].magia, CONTROL_MAGIA, sizeof(estados[f].magia)) == 0;
+        if (validos[f] && (cabeceras[f].tipo != MATRIZ_REAL || cabeceras[f].filas != M || cabeceras[f].columnas != N
+            || estados[f].nueve_puntos != nueve_puntos || estados[f].periodico != periodico)) {
+            if (mirango == 0) {
+                printf("  - '%s' es de otro problema (%lld × %lld), se ignora\n", nombre,
+                    (long long)cabeceras[f].filas, (long long)cabeceras[f].columnas);
+            }
+            validos[f] = 0;
+        }
+    }
+    int primero = validos[1] && (!validos[0] || estados[1].iteracion > estados[0].iteracion) ? 1 : 0;
+    for (int intento = 0; intento < 2; intento++) {
+        int f = intento == 0 ? primero : 1 - primero;
+        if (!validos[f]) {
+            continue;
+        }
+        nombre_control(nombre, sizeof(nombre), f);
+        int resultado = matriz_leer(comm, nombre, pistas, &cabeceras[f], campo, tesela, 1);
+        if (resultado == MATRIZ_OK) {
+            *estado = estados[f];
+            return f;
+        }
+        if (mirango == 0) {
+            printf("  - '%s' (iteracion %lld) no se puede usar: %s\n", nombre,
+                (long long)estados[f].iteracion, matriz_mensaje(resultado));
+        }
+    }
+    return -1;
+}
+
+void ejecutar_jacobi(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    int M = argc > 2 ? atoi(argv[2]) : JACOBI_N_DEFECTO;
+    int N = argc > 3 ? atoi(argv[3]) : M;
+    int iteraciones = argc > 4 ? atoi(argv[4]) : JACOBI_ITERACIONES;
+    int nueve_puntos = argc > 5 && atoi(argv[5]) == 9;
+    int periodico = argc > 6 && strcmp(argv[6], "periodico") == 0;
+    semilla_t semilla = argc > 7 ? strtoull(argv[7], NULL, 10) : 0;
+    int vecindad = argc > 8 && strcmp(argv[8], "vecindad") == 0;
+    int cada = argc > 9 ? atoi(argv[9]) : 0;
+    int reanudar = argc > 10 && strcmp(argv[10], "reanudar") == 0;
+    if (M <= 0 || N <= 0 || iteraciones < 0 || cada < 0) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+        if (mirango == 0) {
+            fprintf(stderr, "ERROR: Uso: jacobi [M] [N] [iteraciones] [5|9] [fijo|periodico] [semilla] [p2p|vecindad]"
+                " [cada] [reanudar]\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Malla de procesos según la forma del dominio y comunicador cartesiano
+    int dims[2] = { 0, 0 };
+    int periods[2] = { periodico, periodico };
+    int coords[2];
+    MPI_Comm comm_cart;
+    elegir_malla(numprocs, M, N, dims);
+    MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &comm_cart);
+    MPI_Comm_rank(comm_cart, &mirango);
+    MPI_Cart_coords(comm_cart, mirango, 2, coords);
+    if (dims[0] > M || dims[1] > N) {
+        if (mirango == 0) {
+            fprintf(stderr, "ERROR: La malla %d × %d deja teselas vacias en un dominio %d × %d.\n",
+                dims[0], dims[1], M, N);
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int fila_inicio, filas, columna_inicio, columnas;
+    calcular_bloque(M, dims[0], coords[0], &fila_inicio, &filas);
+    calcular_bloque(N, dims[1], coords[1], &columna_inicio, &columnas);
+    int ancho = columnas + 2;
+    size_t elementos = (size_t)(filas + 2) * ancho;
+    double* actual = (double*)calloc(elementos, sizeof(double));
+    double* siguiente = (double*)calloc(elementos, sizeof(double));
+    if (actual == NULL || siguiente == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para la tesela.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Estado inicial aleatorio en [0, 100] según la posición global; con
+    // contorno fijo, la fila fantasma superior del dominio está a 100 grados
+    for (int i = 1; i <= filas; i++) {
+        for (int j = 1; j <= columnas; j++) {
+            unsigned long long posicion =
+                (unsigned long long)(fila_inicio + i - 1) * N + columna_inicio + j - 1;
+            actual[(size_t)i * ancho + j] = aleatorio_entero(semilla, posicion, 0, 100);
+        }
+    }
+    if (!periodico && coords[0] == 0) {
+        for (int j = 0; j < ancho; j++) {
+            actual[j] = siguiente[j] = JACOBI_TEMPERATURA_BORDE;
+        }
+    }
+
+    // Puntos de control: la tesela sin bordes dentro del campo y una copia
+    // contigua que se escribe mientras se sigue iterando
+    MPI_Info pistas = MPI_INFO_NULL;
+    double* instantanea = NULL;
+    TeselaMatriz tesela_campo = matriz_tesela(fila_inicio, columna_inicio, filas, columnas, ancho);
+    TeselaMatriz tesela_copia = matriz_tesela(fila_inicio, columna_inicio, filas, columnas, columnas);
+    EstadoJacobi estado;
+    memset(&estado, 0, sizeof(estado));
+    int iteracion_inicial = 0, fichero_reanudado = -1, siguiente_fichero = 0;
+    if (cada > 0 || reanudar) {
+        pistas = pistas_cargar(comm_cart);
+        instantanea = (double*)malloc(((size_t)filas * columnas > 0 ? (size_t)filas * columnas : 1) * sizeof(double));
+        if (instantanea == NULL) {
+            fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para el punto de control.\n", mirango);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    if (reanudar) {
+        fichero_reanudado = jacobi_reanudar(comm_cart, pistas, M, N, nueve_puntos, periodico,
+            actual + ancho + 1, tesela_campo, &estado);
+        if (fichero_reanudado >= 0) {
+            // Los puntos de control siguientes deben seguir guardando la semilla con la que empezó
+            if (semilla != 0 && semilla != estado.semilla) {
+                if (mirango == 0) {
+                    fprintf(stderr, "ERROR: El punto de control es de la semilla %llu, no de la %llu.\n",
+                        (unsigned long long)estado.semilla, (unsigned long long)semilla);
+                }
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            semilla = estado.semilla;
+            iteracion_inicial = (int)estado.iteracion;
+            siguiente_fichero = 1 - fichero_reanudado;
+        }
+    }
+    else if (cada > 0 && mirango == 0) {
+        // Sin reanudar se empieza de cero: un punto de control viejo de otra
+        // ejecución podría parecer más reciente que los nuevos
+        char nombre[64];
+        for (int f = 0; f < 2; f++) {
+            nombre_control(nombre, sizeof(nombre), f);
+            MPI_File_delete(nombre, MPI_INFO_NULL);
+        }
+    }
+
+    Halo halo;
+    halo_iniciar(&halo, comm_cart, filas, columnas, nueve_puntos, vecindad);
+    MPI_Request peticiones[16];
+
+    if (mirango == 0) {
+        printf("================================================================================\n");
+        printf("  JACOBI %d PUNTOS CON INTERCAMBIO DE BORDES NO BLOQUEANTE\n", nueve_puntos ? 9 : 5);
+        printf("================================================================================\n");
+        printf("  - Dominio: %d × %d, %d iteraciones, contorno %s\n", M, N, iteraciones,
+            periodico ? "periodico" : "fijo");
+        printf("  - Topologia: %d × %d procesos, teselas de hasta %d × %d\n", dims[0], dims[1],
+            (M + dims[0] - 1) / dims[0], (N + dims[1] - 1) / dims[1]);
+        if (vecindad) {
+            printf("  - Intercambio: MPI_Ineighbor_alltoallw con tipos subarray\n\n");
+        }
+        else {
+            printf("  - Intercambio: %d Irecv/Isend por tesela e iteracion\n", 2 * halo.direcciones);
+        }
+        if (cada > 0) {
+            printf("  - Puntos de control: cada %d iteraciones en %s.{0,1}.mat\n", cada, CONTROL_FICHERO);
+        }
+        if (reanudar && fichero_reanudado >= 0) {
+            printf("  - Reanudado desde %s.%d.mat en la iteracion %d (semilla %llu)\n", CONTROL_FICHERO,
+                fichero_reanudado, iteracion_inicial, (unsigned long long)estado.semilla);
+        }
+        else if (reanudar) {
+            printf("  - No hay ningun punto de control valido: se empieza de cero\n");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    double tiempo_calculo = 0.0, tiempo_comunicacion = 0.0, tiempo_control = 0.0, cambio = 0.0;
+    EscrituraMatriz control;
+    int control_pendiente = 0, puntos_control = 0, errores_control = 0;
+    MPI_Barrier(comm_cart);
+    double tiempo_inicio = MPI_Wtime();
+    for (int it = iteracion_inicial; it < iteraciones; it++) {
+        double t0 = MPI_Wtime();
+        int pendientes = halo_lanzar(&halo, actual, peticiones);
+        double t1 = MPI_Wtime();
+        // El interior no lee el halo: se calcula mientras llegan los bordes
+        cambio = jacobi_region(actual, siguiente, ancho, 2, filas - 1, 2, columnas - 1, nueve_puntos);
+        double t2 = MPI_Wtime();
+        MPI_Waitall(pendientes, peticiones, MPI_STATUSES_IGNORE);
+        double t3 = MPI_Wtime();
+        double c = jacobi_anillo(actual, siguiente, filas, columnas, ancho, nueve_puntos);
+        if (c > cambio) cambio = c;
+        double t4 = MPI_Wtime();
+        tiempo_comunicacion += (t1 - t0) + (t3 - t2);
+        tiempo_calculo += (t2 - t1) + (t4 - t3);
+
+        double* tmp = actual;
+        actual = siguiente;
+        siguiente = tmp;
+
+        if (control_pendiente) {
+            matriz_escribir_avanzar(&control);
+        }
+        if (cada > 0 && (it + 1) % cada == 0) {
+            // El punto de control anterior tiene que haber terminado antes de
+            // reutilizar la copia; este va al otro fichero
+            double t5 = MPI_Wtime();
+            if (control_pendiente) {
+                errores_control += matriz_escribir_terminar(&control) != MATRIZ_OK;
+            }
+            for (int i = 0; i < filas; i++) {
+                memcpy(instantanea + (size_t)i * columnas, actual + (size_t)(i + 1) * ancho + 1,
+                    (size_t)columnas * sizeof(double));
+            }
+            memcpy(estado.magia, CONTROL_MAGIA, sizeof(estado.magia));
+            estado.iteracion = it + 1;
+            estado.semilla = semilla;
+            estado.nueve_puntos = nueve_puntos;
+            estado.periodico = periodico;
+            char nombre[64];
+            nombre_control(nombre, sizeof(nombre), siguiente_fichero);
+            matriz_escribir_iniciar(comm_cart, nombre, pistas, MATRIZ_REAL, M, N, MATRIZ_TESELAS, dims,
+                instantanea, tesela_copia, &estado, (int)sizeof(estado), &control, NULL);
+            control_pendiente = 1;
+            siguiente_fichero = 1 - siguiente_fichero;
+            puntos_control++;
+            tiempo_control += MPI_Wtime() - t5;
+        }
+    }
+    if (control_pendiente) {
+        double t5 = MPI_Wtime();
+        errores_control += matriz_escribir_terminar(&control) != MATRIZ_OK;
+        tiempo_control += MPI_Wtime() - t5;
+    }
+    double tiempo_total = MPI_Wtime() - tiempo_inicio;
+
+    // Resumen: tiempos del proceso más lento, último cambio máximo y suma del campo
+    double locales[4] = { tiempo_calculo, tiempo_comunicacion, tiempo_total, tiempo_control };
+    double maximos[4];
+    MPI_Reduce(locales, maximos, 4, MPI_DOUBLE, MPI_MAX, 0, comm_cart);
+    double cambio_global;
+    MPI_Reduce(&cambio, &cambio_global, 1, MPI_DOUBLE, MPI_MAX, 0, comm_cart);
+    double suma_local = 0.0, suma;
+    for (int i = 1; i <= filas; i++) {
+        for (int j = 1; j <= columnas; j++) {
+            suma_local += actual[(size_t)i * ancho + j];
+        }
+    }
+    MPI_Reduce(&suma_local, &suma, 1, MPI_DOUBLE, MPI_SUM, 0, comm_cart);
+
+    if (mirango == 0) {
+        int ejecutadas = iteraciones > iteracion_inicial ? iteraciones - iteracion_inicial : 0;
+        int n = ejecutadas > 0 ? ejecutadas : 1;
+        printf("Tiempo por iteracion (proceso mas lento):\n");
+        printf("  - Calculo:      %10.2f us\n", maximos[0] / n * 1e6);
+        printf("  - Comunicacion: %10.2f us (lanzar + esperar, no oculta tras el interior)\n",
+            maximos[1] / n * 1e6);
+        printf("  - Total:        %10.2f us\n", maximos[2] / n * 1e6);
+        printf("Actualizaciones: %.1f millones de celdas/s\n",
+            (double)M * N * ejecutadas / (maximos[2] > 0.0 ? maximos[2] : 1.0) / 1e6);
+        if (puntos_control > 0) {
+            printf("Puntos de control: %d escritos (%s), %.3f s bloqueado en copia y esperas\n",
+                puntos_control, errores_control == 0 ? "correctos" : "con errores", maximos[3]);
+        }
+        printf("Cambio maximo en la ultima iteracion: %.6e\n", cambio_global);
+        printf("Temperatura media: %.10f\n", suma / ((double)M * N));
+        printf("================================================================================\n");
+    }
+
+    halo_liberar(&halo);
+    free(actual);
+    free(siguiente);
+    free(instantanea);
+    if (pistas != MPI_INFO_NULL) {
+        MPI_Info_free(&pistas);
+    }
+    MPI_Comm_free(&comm_cart);
+}
+
+/*
+   Benchmark del intercambio de bordes: p2p frente a colectiva de vecindad.
+   Para subcomunicadores de 1, 2, 4, ... y P procesos y teselas de lado
+   16, 64, 256, ... hasta 'lado_max', con malla periódica cuadrada
+   (todas las teselas tienen sus 4 u 8 vecinos). Antes de medir se comprueba
+   que los dos métodos dejan en el halo los valores de la posición global
+   correcta. Tiempo por intercambio del proceso más lento.
+   Uso: mpiexec -n P Practica4.exe halo [5|9] [lado_max] [iteraciones]
+*/
+#define HALO_LADO_MIN 16
+#define HALO_LADO_MAX 1024
+#define HALO_ITERACIONES 200
+
+// Rellena la tesela (halo incluido) con -1 y los datos propios con su posición global
+void halo_rellenar_posiciones(double* campo, int filas, int columnas, int fila0, int col0, int N)
+{
+    int ancho = columnas + 2;
+    for (size_t e = 0; e < (size_t)(filas + 2) * ancho; e++) campo[e] = -1.0;
+    for (int i = 1; i <= filas; i++) {
+        for (int j = 1; j <= columnas; j++) {
+            campo[(size_t)i * ancho + j] = (double)(fila0 + i - 1) * N + col0 + j - 1;
+        }
+    }
+}
+
+// Comprueba que cada celda fantasma tiene la posición global (periódica) que le toca
+int halo_comprobar(const double* campo, int filas, int columnas, int fila0, int col0, int M, int N, int nueve_puntos)
+{
+    int ancho = columnas + 2;
+    for (int i = 0; i <= filas + 1; i++) {
+        for (int j = 0; j <= columnas + 1; j++) {
+            int borde_i = i == 0 || i == filas + 1, borde_j = j == 0 || j == columnas + 1;
+            if (!borde_i && !borde_j) continue;
+            if (borde_i && borde_j && !nueve_puntos) continue;
+            int fg = ((fila0 + i - 1) % M + M) % M, cg = ((col0 + j - 1) % N + N) % N;
+            if (campo[(size_t)i * ancho + j] != (double)fg * N + cg) return 0;
+        }
+    }
+    return 1;
+}
+
+// Tiempo medio de un intercambio completo (lanzar + esperar), máximo entre procesos
+double halo_medir(const Halo* h, double* campo, int iteraciones)
+{
+    MPI_Request peticiones[16];
+    MPI_Waitall(halo_lanzar(h, campo, peticiones), peticiones, MPI_STATUSES_IGNORE);
+    MPI_Barrier(h->comm);
+    double t = MPI_Wtime();
+    for (int it = 0; it < iteraciones; it++) {
+        MPI_Waitall(halo_lanzar(h, campo, peticiones), peticiones, MPI_STATUSES_IGNORE);
+    }
+    t = (MPI_Wtime() - t) / iteraciones;
+    double maximo;
+    MPI_Allreduce(&t, &maximo, 1, MPI_DOUBLE, MPI_MAX, h->comm);
+    return maximo;
+}
+
+void ejecutar_halo(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    int nueve_puntos = argc > 2 && atoi(argv[2]) == 9;
+    int lado_max = argc > 3 ? atoi(argv[3]) : HALO_LADO_MAX;
+    int iteraciones = argc > 4 ? atoi(argv[4]) : HALO_ITERACIONES;
+    if (iteraciones <= 0) iteraciones = 1;
+
+    if (mirango == 0) {
+        printf("# Intercambio de bordes %d puntos: %d Irecv/Isend frente a MPI_Ineighbor_alltoallw, %d repeticiones\n",
+            nueve_puntos ? 9 : 5, nueve_puntos ? 16 : 8, iteraciones);
+        printf("procesos,malla,lado,p2p_us,vecindad_us,vecindad/p2p,comprobacion\n");
+        fflush(stdout);
+    }
+    for (int p = 1; p <= numprocs; p = (p * 2 > numprocs && p < numprocs) ? numprocs : p * 2) {
+        MPI_Comm sub;
+        MPI_Comm_split(MPI_COMM_WORLD, mirango < p ? 0 : MPI_UNDEFINED, mirango, &sub);
+        if (sub != MPI_COMM_NULL) {
+            int dims[2] = { 0, 0 }, periods[2] = { 1, 1 }, coords[2], rango;
+            MPI_Comm comm_cart;
+            MPI_Dims_create(p, 2, dims);
+            MPI_Cart_create(sub, 2, dims, periods, 1, &comm_cart);
+            MPI_Comm_rank(comm_cart, &rango);
+            MPI_Cart_coords(comm_cart, rango, 2, coords);
+            for (int lado = HALO_LADO_MIN; lado <= lado_max; lado *= 4) {
+                int M = lado * dims[0], N = lado * dims[1];
+                int fila0 = coords[0] * lado, col0 = coords[1] * lado;
+                double* campo = (double*)malloc((size_t)(lado + 2) * (lado + 2) * sizeof(double));
+                if (campo == NULL) {
+                    fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para la tesela.\n", mirango);
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+                Halo p2p, vecindad;
+                halo_iniciar(&p2p, comm_cart, lado, lado, nueve_puntos, 0);
+                halo_iniciar(&vecindad, comm_cart, lado, lado, nueve_puntos, 1);
+
+                MPI_Request peticiones[16];
+                int correcto = 1;
+                const Halo* metodos[2] = { &p2p, &vecindad };
+                for (int m = 0; m < 2; m++) {
+                    halo_rellenar_posiciones(campo, lado, lado, fila0, col0, N);
+                    MPI_Waitall(halo_lanzar(metodos[m], campo, peticiones), peticiones, MPI_STATUSES_IGNORE);
+                    correcto &= halo_comprobar(campo, lado, lado, fila0, col0, M, N, nueve_puntos);
+                }
+                MPI_Allreduce(MPI_IN_PLACE, &correcto, 1, MPI_INT, MPI_LAND, comm_cart);
+
+                double t_p2p = halo_medir(&p2p, campo, iteraciones);
+                double t_vecindad = halo_medir(&vecindad, campo, iteraciones);
+                if (mirango == 0) {
+                    printf("%d,%dx%d,%d,%.2f,%.2f,%.2f,%s\n", p, dims[0], dims[1], lado, t_p2p * 1e6,
+                        t_vecindad * 1e6, t_vecindad / t_p2p, correcto ? "OK" : "ERROR");
+                    fflush(stdout);
+                }
+                halo_liberar(&p2p);
+                halo_liberar(&vecindad);
+                free(campo);
+            }
+            MPI_Comm_free(&comm_cart);
+            MPI_Comm_free(&sub);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (p == numprocs) break;
+    }
+}
+
+// =============================================================================
+// PRODUCTO DE MATRICES DISTRIBUIDO: SUMMA Y CANNON (modos 'producto' y 'escalado')
+// =============================================================================
+/*
+   C (M × N) = A (M × K) · B (K × N) en doble precisión sobre una malla pr × pc.
+   Los elementos de A y B son enteros 0..9 generados en local a partir de la
+   semilla, así que el resultado es exacto y se comprueba con una suma
+   ponderada por posición (detecta bloques fuera de sitio):
+       sum_ij w_i·C_ij·v_j = sum_k (sum_i w_i·A_ik) · (sum_j B_kj·v_j)
+   con pesos w_i = 1 + i % 7 y v_j = 1 + j % 5
+   - SUMMA: cualquier malla. El proceso (i,j) tiene las filas del bloque i y
+     las columnas del bloque j de C, el trozo correspondiente de A (columnas
+     de K repartidas entre pc) y de B (filas de K repartidas entre pr). K se
+     recorre en paneles que caen enteros dentro de un bloque de cada reparto:
+     el panel de A se difunde por la fila de procesos y el de B por la columna,
+     ambos con comunicadores de MPI_Cart_sub
+   - Cannon: malla q × q periódica y bloques ceil(·/q) con relleno a cero. Tras
+     el sesgo inicial, q pasos de producto local y desplazamiento circular de
+     A hacia la izquierda y de B hacia arriba
+   Uso: mpiexec -n P Practica4.exe producto [summa|cannon] [M] [N] [K] [semilla]
+        mpiexec -n P Practica4.exe escalado [summa|cannon] [n] [fuerte|debil] [repeticiones]
+*/
+#define PRODUCTO_N_DEFECTO 1024
+#define PRODUCTO_PANEL_MAX 256
+#define PRODUCTO_REPETICIONES 3
+// Tamaño de bloque del producto local: tres bloques de 64×64 doubles (96 KB)
+// caben en la caché L2
+#define GEMM_BLOQUE 64
+
+/*
+   C (m × n, ldc) += A (m × k, lda) · B (k × n, ldb), por bloques para
+   reutilizar en caché; el bucle interno recorre filas de B y C de forma
+   contigua para que el compilador lo vectorice
+*/
+void gemm_bloques(int m, int n, int k, const double* A, int lda, const double* B, int ldb, double* C, int ldc)
+{
+    for (int ii = 0; ii < m; ii += GEMM_BLOQUE) {
+        int i1 = ii + GEMM_BLOQUE < m ? ii + GEMM_BLOQUE : m;
+        for (int kk = 0; kk < k; kk += GEMM_BLOQUE) {
+            int k1 = kk + GEMM_BLOQUE < k ? kk + GEMM_BLOQUE : k;
+            for (int jj = 0; jj < n; jj += GEMM_BLOQUE) {
+                int j1 = jj + GEMM_BLOQUE < n ? jj + GEMM_BLOQUE : n;
+                for (int i = ii; i < i1; i++) {
+                    double* c = C + (size_t)i * ldc;
+                    for (int p = kk; p < k1; p++) {
+                        double a = A[(size_t)i * lda + p];
+                        const double* b = B + (size_t)p * ldb;
+                        for (int j = jj; j < j1; j++) {
+                            c[j] += a * b[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Bloque del reparto equilibrado de 'total' en 'partes' al que pertenece 'indice'
+int bloque_de(int total, int partes, int indice)
+{
+    int base = total / partes;
+    int resto = total % partes;
+    if (indice < resto * (base + 1)) return indice / (base + 1);
+    return resto + (indice - resto * (base + 1)) / base;
+}
+
+// Rellena un bloque filas × columnas (ld = columnas) con los elementos
+// [fila0.., col0..] de una matriz de 'ancho_global' columnas; fuera de
+// 'filas_validas' × 'columnas_validas' queda a cero (relleno de Cannon)
+void generar_bloque(double* bloque, int filas, int columnas, int filas_validas, int columnas_validas,
+    int fila0, int col0, int ancho_global, semilla_t semilla)
+{
+    for (int i = 0; i < filas; i++) {
+        for (int j = 0; j < columnas; j++) {
+            double valor = 0.0;
+            if (i < filas_validas && j < columnas_validas) {
+                unsigned long long posicion = (unsigned long long)(fila0 + i) * ancho_global + col0 + j;
+                valor = aleatorio_entero(semilla, posicion, 0, 9);
+            }
+            bloque[(size_t)i * columnas + j] = valor;
+        }
+    }
+}
+
+typedef struct {
+    int dims[2];
+    double tiempo;       // Producto (sin generación), proceso más lento
+    double suma;         // Suma ponderada de C
+    double esperado;     // Valor de la comprobación
+} ResultadoProducto;
+
+double peso_fila(int i) { return 1.0 + i % 7; }
+double peso_columna(int j) { return 1.0 + j % 5; }
+
+/*
+   Aporta a 'sumas_k' (vector de K) las sumas ponderadas por w_i de las
+   columnas de un bloque de A que empieza en (fila0, k0) o, con traspuesta = 1,
+   las sumas ponderadas por v_j de las filas de un bloque de B que empieza en
+   (k0, col0). 'origen' es fila0 o col0 según el caso
+*/
+void sumas_comprobacion(const double* bloque, int filas, int columnas, int k0, int origen,
+    int traspuesta, double* sumas_k)
+{
+    for (int i = 0; i < filas; i++) {
+        for (int j = 0; j < columnas; j++) {
+            double x = bloque[(size_t)i * columnas + j];
+            if (traspuesta) sumas_k[k0 + i] += x * peso_columna(origen + j);
+            else sumas_k[k0 + j] += x * peso_fila(origen + i);
+        }
+    }
+}
+
+// Reúne las sumas parciales y calcula el valor esperado y la suma ponderada real
+// de C, cuyo bloque local empieza en (fila0, col0)
+void comprobar_producto(MPI_Comm comm, int K, double* sumasA, double* sumasB,
+    const double* C, int filas, int columnas, int fila0, int col0, ResultadoProducto* r)
+{
+    MPI_Allreduce(MPI_IN_PLACE, sumasA, K, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(MPI_IN_PLACE, sumasB, K, MPI_DOUBLE, MPI_SUM, comm);
+    r->esperado = 0.0;
+    for (int k = 0; k < K; k++) {
+        r->esperado += sumasA[k] * sumasB[k];
+    }
+    double suma_local = 0.0;
+    for (int i = 0; i < filas; i++) {
+        for (int j = 0; j < columnas; j++) {
+            suma_local += peso_fila(fila0 + i) * C[(size_t)i * columnas + j] * peso_columna(col0 + j);
+        }
+    }
+    MPI_Allreduce(&suma_local, &r->suma, 1, MPI_DOUBLE, MPI_SUM, comm);
+}
+
+void reservar_o_abortar(double** p, size_t elementos, const char* que)
+{
+    *p = (double*)calloc(elementos > 0 ? elementos : 1, sizeof(double));
+    if (*p == NULL) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para %s (%zu elementos).\n", que, elementos);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// SUMMA sobre todos los procesos de 'comm' con la malla elegida por perímetro
+void producto_summa(MPI_Comm comm, int M, int N, int K, semilla_t semilla, ResultadoProducto* r)
+{
+    int numprocs, mirango, coords[2];
+    int periods[2] = { 0, 0 };
+    int dims[2] = { 0, 0 };
+    MPI_Comm comm_cart, comm_fila, comm_columna;
+    MPI_Comm_size(comm, &numprocs);
+    elegir_malla(numprocs, M, N, dims);
+    MPI_Cart_create(comm, 2, dims, periods, 1, &comm_cart);
+    MPI_Comm_rank(comm_cart, &mirango);
+    MPI_Cart_coords(comm_cart, mirango, 2, coords);
+
+    // Fila de procesos (varía la columna) y columna de procesos (varía la fila):
+    // en cada una el rango coincide con la coordenada que varía
+    int libre_fila[2] = { 0, 1 }, libre_columna[2] = { 1, 0 };
+    MPI_Cart_sub(comm_cart, libre_fila, &comm_fila);
+    MPI_Cart_sub(comm_cart, libre_columna, &comm_columna);
+
+    int fila0, filas, col0, columnas, kA0, kA, kB0, kB;
+    calcular_bloque(M, dims[0], coords[0], &fila0, &filas);
+    calcular_bloque(N, dims[1], coords[1], &col0, &columnas);
+    calcular_bloque(K, dims[1], coords[1], &kA0, &kA);   // columnas de A propias
+    calcular_bloque(K, dims[0], coords[0], &kB0, &kB);   // filas de B propias
+
+    double *A, *B, *C, *panelA, *panelB, *sumasA, *sumasB;
+    reservar_o_abortar(&A, (size_t)filas * kA, "el bloque de A");
+    reservar_o_abortar(&B, (size_t)kB * columnas, "el bloque de B");
+    reservar_o_abortar(&C, (size_t)filas * columnas, "el bloque de C");
+    reservar_o_abortar(&panelA, (size_t)filas * PRODUCTO_PANEL_MAX, "el panel de A");
+    reservar_o_abortar(&panelB, (size_t)PRODUCTO_PANEL_MAX * columnas, "el panel de B");
+    reservar_o_abortar(&sumasA, K, "las sumas de A");
+    reservar_o_abortar(&sumasB, K, "las sumas de B");
+    generar_bloque(A, filas, kA, filas, kA, fila0, kA0, K, aleatorio_flujo(semilla, 0));
+    generar_bloque(B, kB, columnas, kB, columnas, kB0, col0, N, aleatorio_flujo(semilla, 1));
+
+    MPI_Barrier(comm_cart);
+    double t = MPI_Wtime();
+    for (int k = 0; k < K; ) {
+        // Panel [k, k1): dentro del bloque de columnas de A de la columna de
+        // procesos jA y del bloque de filas de B de la fila de procesos iB
+        int jA = bloque_de(K, dims[1], k), iB = bloque_de(K, dims[0], k);
+        int ini, cant, k1 = k + PRODUCTO_PANEL_MAX < K ? k + PRODUCTO_PANEL_MAX : K;
+        calcular_bloque(K, dims[1], jA, &ini, &cant);
+        if (ini + cant < k1) k1 = ini + cant;
+        calcular_bloque(K, dims[0], iB, &ini, &cant);
+        if (ini + cant < k1) k1 = ini + cant;
+        int ancho = k1 - k;
+
+        if (coords[1] == jA) {
+            for (int i = 0; i < filas; i++) {
+                memcpy(panelA + (size_t)i * ancho, A + (size_t)i * kA + (k - kA0), ancho * sizeof(double));
+            }
+        }
+        MPI_Bcast(panelA, filas * ancho, MPI_DOUBLE, jA, comm_fila);
+
+        // Las filas de B del panel ya son contiguas en el propietario
+        double* filasB = coords[0] == iB ? B + (size_t)(k - kB0) * columnas : panelB;
+        MPI_Bcast(filasB, ancho * columnas, MPI_DOUBLE, iB, comm_columna);
+
+        gemm_bloques(filas, columnas, ancho, panelA, ancho, filasB, columnas, C, columnas);
+        k = k1;
+    }
+    t = MPI_Wtime() - t;
+    MPI_Allreduce(&t, &r->tiempo, 1, MPI_DOUBLE, MPI_MAX, comm_cart);
+
+    sumas_comprobacion(A, filas, kA, kA0, fila0, 0, sumasA);
+    sumas_comprobacion(B, kB, columnas, kB0, col0, 1, sumasB);
+    comprobar_producto(comm_cart, K, sumasA, sumasB, C, filas, columnas, fila0, col0, r);
+    r->dims[0] = dims[0];
+    r->dims[1] = dims[1];
+
+    free(A); free(B); free(C); free(panelA); free(panelB); free(sumasA); free(sumasB);
+    MPI_Comm_free(&comm_fila);
+    MPI_Comm_free(&comm_columna);
+    MPI_Comm_free(&comm_cart);
+}
+
+// Cannon sobre una malla q × q periódica; devuelve 0 si P no es un cuadrado
+int producto_cannon(MPI_Comm comm, int M, int N, int K, semilla_t semilla, ResultadoProducto* r)
+{
+    int numprocs, mirango, coords[2];
+    MPI_Comm_size(comm, &numprocs);
+    int q = (int)(sqrt((double)numprocs) + 0.5);
+    if (q * q != numprocs) {
+        return 0;
+    }
+    int dims[2] = { q, q }, periods[2] = { 1, 1 };
+    MPI_Comm comm_cart, comm_fila, comm_columna;
+    MPI_Cart_create(comm, 2, dims, periods, 1, &comm_cart);
+    MPI_Comm_rank(comm_cart, &mirango);
+    MPI_Cart_coords(comm_cart, mirango, 2, coords);
+    int libre_fila[2] = { 0, 1 }, libre_columna[2] = { 1, 0 };
+    MPI_Cart_sub(comm_cart, libre_fila, &comm_fila);
+    MPI_Cart_sub(comm_cart, libre_columna, &comm_columna);
+
+    int bm = (M + q - 1) / q, bn = (N + q - 1) / q, bk = (K + q - 1) / q;
+    int i = coords[0], j = coords[1];
+    double *A, *B, *C, *sumasA, *sumasB;
+    reservar_o_abortar(&A, (size_t)bm * bk, "el bloque de A");
+    reservar_o_abortar(&B, (size_t)bk * bn, "el bloque de B");
+    reservar_o_abortar(&C, (size_t)bm * bn, "el bloque de C");
+    reservar_o_abortar(&sumasA, (size_t)q * bk, "las sumas de A");
+    reservar_o_abortar(&sumasB, (size_t)q * bk, "las sumas de B");
+    generar_bloque(A, bm, bk, elementos_tesela(M, bm, i), elementos_tesela(K, bk, j),
+        i * bm, j * bk, K, aleatorio_flujo(semilla, 0));
+    generar_bloque(B, bk, bn, elementos_tesela(K, bk, i), elementos_tesela(N, bn, j),
+        i * bk, j * bn, N, aleatorio_flujo(semilla, 1));
+    // Las sumas de comprobación se toman antes del sesgo (con relleno a cero)
+    sumas_comprobacion(A, bm, bk, j * bk, i * bm, 0, sumasA);
+    sumas_comprobacion(B, bk, bn, i * bk, j * bn, 1, sumasB);
+
+    MPI_Barrier(comm_cart);
+    double t = MPI_Wtime();
+    int origen, destino;
+    // Sesgo inicial: A(i,j) <- A(i,j+i), B(i,j) <- B(i+j,j)
+    MPI_Cart_shift(comm_fila, 0, -i, &origen, &destino);
+    MPI_Sendrecv_replace(A, bm * bk, MPI_DOUBLE, destino, 0, origen, 0, comm_fila, MPI_STATUS_IGNORE);
+    MPI_Cart_shift(comm_columna, 0, -j, &origen, &destino);
+    MPI_Sendrecv_replace(B, bk * bn, MPI_DOUBLE, destino, 0, origen, 0, comm_columna, MPI_STATUS_IGNORE);
+    for (int paso = 0; paso < q; paso++) {
+        gemm_bloques(bm, bn, bk, A, bk, B, bn, C, bn);
+        if (paso == q - 1) break;
+        MPI_Cart_shift(comm_fila, 0, -1, &origen, &destino);
+        MPI_Sendrecv_replace(A, bm * bk, MPI_DOUBLE, destino, 0, origen, 0, comm_fila, MPI_STATUS_IGNORE);
+        MPI_Cart_shift(comm_columna, 0, -1, &origen, &destino);
+        MPI_Sendrecv_replace(B, bk * bn, MPI_DOUBLE, destino, 0, origen, 0, comm_columna, MPI_STATUS_IGNORE);
+    }
+    t = MPI_Wtime() - t;
+    MPI_Allreduce(&t, &r->tiempo, 1, MPI_DOUBLE, MPI_MAX, comm_cart);
+
+    comprobar_producto(comm_cart, q * bk, sumasA, sumasB, C, bm, bn, i * bm, j * bn, r);
+    r->dims[0] = q;
+    r->dims[1] = q;
+
+    free(A); free(B); free(C); free(sumasA); free(sumasB);
+    MPI_Comm_free(&comm_fila);
+    MPI_Comm_free(&comm_columna);
+    MPI_Comm_free(&comm_cart);
+    return 1;
+}
+
+int ejecutar_multiplicacion(MPI_Comm comm, int cannon, int M, int N, int K, semilla_t semilla, ResultadoProducto* r)
+{
+    if (cannon) {
+        return producto_cannon(comm, M, N, K, semilla, r);
+    }
+    producto_summa(comm, M, N, K, semilla, r);
+    return 1;
+}
+
+double gflops(int M, int N, int K, double tiempo)
+{
+    return 2.0 * M * N * K / (tiempo > 0.0 ? tiempo : 1e-12) / 1e9;
+}
+
+void ejecutar_producto(int argc, char* argv[])
+{
+    int mirango;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    int cannon = argc > 2 && strcmp(argv[2], "cannon") == 0;
+    int M = argc > 3 ? atoi(argv[3]) : PRODUCTO_N_DEFECTO;
+    int N = argc > 4 ? atoi(argv[4]) : M;
+    int K = argc > 5 ? atoi(argv[5]) : M;
+    semilla_t semilla = argc > 6 ? strtoull(argv[6], NULL, 10) : 0;
+    if (M <= 0 || N <= 0 || K <= 0) {
+        if (mirango == 0) fprintf(stderr, "ERROR: Uso: producto [summa|cannon] [M] [N] [K] [semilla]\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    ResultadoProducto r;
+    if (!ejecutar_multiplicacion(MPI_COMM_WORLD, cannon, M, N, K, semilla, &r)) {
+        if (mirango == 0) fprintf(stderr, "ERROR: Cannon necesita un numero de procesos cuadrado.\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (mirango == 0) {
+        printf("================================================================================\n");
+        printf("  PRODUCTO C = A·B CON %s\n", cannon ? "CANNON" : "SUMMA");
+        printf("================================================================================\n");
+        printf("  - A: %d × %d, B: %d × %d, malla %d × %d\n", M, K, K, N, r.dims[0], r.dims[1]);
+        printf("  - Tiempo: %.6f segundos, %.2f GFLOP/s\n", r.tiempo, gflops(M, N, K, r.tiempo));
+        printf("  - Comprobacion: suma ponderada de C = %.0f, esperado %.0f -> %s\n", r.suma, r.esperado,
+            r.suma == r.esperado ? "OK" : "ERROR");
+        printf("================================================================================\n");
+    }
+}
+
+/*
+   Escalado: el mismo producto sobre subcomunicadores de 1, 2, 4, ... procesos
+   (cuadrados perfectos con Cannon) y todos. Fuerte: n fijo. Débil: n crece
+   con la raíz cúbica de p para mantener los FLOP por proceso
+*/
+void ejecutar_escalado(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    int cannon = argc > 2 && strcmp(argv[2], "cannon") == 0;
+    int n_base = argc > 3 ? atoi(argv[3]) : PRODUCTO_N_DEFECTO;
+    int debil = argc > 4 && strcmp(argv[4], "debil") == 0;
+    int repeticiones = argc > 5 ? atoi(argv[5]) : PRODUCTO_REPETICIONES;
+    if (n_base <= 0) n_base = PRODUCTO_N_DEFECTO;
+    if (repeticiones <= 0) repeticiones = 1;
+
+    if (mirango == 0) {
+        printf("# Escalado %s de %s, n base %d, mejor de %d\n", debil ? "debil" : "fuerte",
+            cannon ? "Cannon" : "SUMMA", n_base, repeticiones);
+        printf("procesos,malla,n,tiempo_s,gflops,aceleracion,eficiencia,comprobacion\n");
+        fflush(stdout);
+    }
+    double tiempo_uno = 0.0;
+    for (int p = 1; p <= numprocs; ) {
+        int n = debil ? (int)(n_base * cbrt((double)p) + 0.5) : n_base;
+        MPI_Comm sub;
+        MPI_Comm_split(MPI_COMM_WORLD, mirango < p ? 0 : MPI_UNDEFINED, mirango, &sub);
+        if (sub != MPI_COMM_NULL) {
+            ResultadoProducto mejor = { { 0, 0 }, 1e30, 0.0, 0.0 }, r;
+            for (int rep = 0; rep < repeticiones; rep++) {
+                ejecutar_multiplicacion(sub, cannon, n, n, n, 0, &r);
+                if (r.tiempo < mejor.tiempo) mejor = r;
+            }
+            if (p == 1) tiempo_uno = mejor.tiempo;
+            if (mirango == 0) {
+                // Débil: eficiencia = t(1) / t(p) con el mismo trabajo por proceso
+                double aceleracion = debil ? tiempo_uno / mejor.tiempo * p : tiempo_uno / mejor.tiempo;
+                printf("%d,%dx%d,%d,%.6f,%.2f,%.2f,%.1f%%,%s\n", p, mejor.dims[0], mejor.dims[1], n,
+                    mejor.tiempo, gflops(n, n, n, mejor.tiempo), aceleracion, 100.0 * aceleracion / p,
+                    mejor.suma == mejor.esperado ? "OK" : "ERROR");
+                fflush(stdout);
+            }
+            MPI_Comm_free(&sub);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        // Siguiente tamaño: potencias de 2 (o cuadrados para Cannon) y al final P
+        int siguiente = p;
+        if (cannon) {
+            int q = (int)(sqrt((double)p) + 0.5) + 1;
+            siguiente = q * q;
+        }
+        else {
+            siguiente = p * 2;
+            if (siguiente > numprocs && p < numprocs) siguiente = numprocs;
+        }
+        p = siguiente;
+    }
+}
+
+// =============================================================================
+// AGREGADOS POR FILAS Y COLUMNAS DE PROCESOS (modo 'agregados')
+// =============================================================================
+/*
+   Sumas por filas, sumas por columnas e y = A·x de una matriz M × N de enteros
+   0..9 repartida en teselas equilibradas. En lugar de llevarlo todo al
+   proceso 0 por comm_cart, cada operación se reduce solo a lo largo de una
+   dimensión de la malla con los comunicadores de MPI_Cart_sub:
+   - suma de filas: reducción por la fila de procesos, queda en la columna 0
+   - suma de columnas: reducción por la columna de procesos, queda en la fila 0
+   - y = A·x: el trozo x_j está en toda la columna j de procesos; A_ij·x_j se
+     suma con MPI_Allreduce por la fila de procesos y y_i queda replicado en
+     la fila i (listo para la siguiente iteración de un método iterativo)
+   Cada proceso participa en reducciones de pc o pr procesos, O(sqrt(P)), en
+   vez de una de P. Como referencia se mide también la suma de filas hecha
+   con un MPI_Reduce de un vector de M elementos por comm_cart.
+   Uso: mpiexec -n P Practica4.exe agregados [M] [N] [semilla]
+*/
+#define AGREGADOS_N_DEFECTO 4096
+
+void ejecutar_agregados(int argc, char* argv[])
+{
+    int mirango, numprocs, coords[2];
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    int M = argc > 2 ? atoi(argv[2]) : AGREGADOS_N_DEFECTO;
+    int N = argc > 3 ? atoi(argv[3]) : M;
+    semilla_t semilla = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+    if (M <= 0 || N <= 0) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+        if (mirango == 0) fprintf(stderr, "ERROR: Uso: agregados [M] [N] [semilla]\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int dims[2] = { 0, 0 }, periods[2] = { 0, 0 };
+    MPI_Comm comm_cart, comm_fila, comm_columna;
+    elegir_malla(numprocs, M, N, dims);
+    MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &comm_cart);
+    MPI_Comm_rank(comm_cart, &mirango);
+    MPI_Cart_coords(comm_cart, mirango, 2, coords);
+    int libre_fila[2] = { 0, 1 }, libre_columna[2] = { 1, 0 };
+    MPI_Cart_sub(comm_cart, libre_fila, &comm_fila);
+    MPI_Cart_sub(comm_cart, libre_columna, &comm_columna);
+
+    int fila0, filas, col0, columnas;
+    calcular_bloque(M, dims[0], coords[0], &fila0, &filas);
+    calcular_bloque(N, dims[1], coords[1], &col0, &columnas);
+
+    // Tesela de A y trozo de x (por filas, generados en local)
+    int* A = (int*)malloc(((size_t)filas * columnas > 0 ? (size_t)filas * columnas : 1) * sizeof(int));
+    long long* x = (long long*)malloc((columnas > 0 ? columnas : 1) * sizeof(long long));
+    long long* suma_filas = (long long*)calloc(filas > 0 ? filas : 1, sizeof(long long));
+    long long* suma_columnas = (long long*)calloc(columnas > 0 ? columnas : 1, sizeof(long long));
+    long long* y = (long long*)calloc(filas > 0 ? filas : 1, sizeof(long long));
+    long long* total_filas = (long long*)calloc(filas > 0 ? filas : 1, sizeof(long long));
+    long long* total_columnas = (long long*)calloc(columnas > 0 ? columnas : 1, sizeof(long long));
+    long long* vector_global = (long long*)calloc(M, sizeof(long long));
+    long long* vector_reducido = mirango == 0 ? (long long*)calloc(M, sizeof(long long)) : NULL;
+    if (A == NULL || x == NULL || suma_filas == NULL || suma_columnas == NULL || y == NULL ||
+        total_filas == NULL || total_columnas == NULL || vector_global == NULL ||
+        (mirango == 0 && vector_reducido == NULL)) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para la tesela.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    semilla_t semillaA = aleatorio_flujo(semilla, 0), semillaX = aleatorio_flujo(semilla, 2);
+    for (int i = 0; i < filas; i++) {
+        for (int j = 0; j < columnas; j++) {
+            unsigned long long posicion = (unsigned long long)(fila0 + i) * N + col0 + j;
+            A[(size_t)i * columnas + j] = aleatorio_entero(semillaA, posicion, 0, 9);
+        }
+    }
+    for (int j = 0; j < columnas; j++) {
+        x[j] = aleatorio_entero(semillaX, col0 + j, 0, 9);
+    }
+
+    // Parciales locales: sumas de fila, de columna y A_ij·x_j
+    for (int i = 0; i < filas; i++) {
+        const int* fila = A + (size_t)i * columnas;
+        long long sf = 0, ax = 0;
+        for (int j = 0; j < columnas; j++) {
+            sf += fila[j];
+            ax += fila[j] * x[j];
+            suma_columnas[j] += fila[j];
+        }
+        suma_filas[i] = sf;
+        y[i] = ax;
+    }
+
+    // Suma de filas: reducción a la columna 0 de procesos
+    MPI_Barrier(comm_cart);
+    double t0 = MPI_Wtime();
+    MPI_Reduce(suma_filas, total_filas, filas, MPI_LONG_LONG, MPI_SUM, 0, comm_fila);
+    double t1 = MPI_Wtime();
+    // Suma de columnas: reducción a la fila 0 de procesos
+    MPI_Reduce(suma_columnas, total_columnas, columnas, MPI_LONG_LONG, MPI_SUM, 0, comm_columna);
+    double t2 = MPI_Wtime();
+    // y = A·x replicado en cada fila de procesos
+    MPI_Allreduce(MPI_IN_PLACE, y, filas, MPI_LONG_LONG, MPI_SUM, comm_fila);
+    double t3 = MPI_Wtime();
+
+    // Referencia: la suma de filas llevada al proceso 0 por comm_cart
+    memcpy(vector_global + fila0, suma_filas, filas * sizeof(long long));
+    MPI_Barrier(comm_cart);
+    double t4 = MPI_Wtime();
+    MPI_Reduce(vector_global, vector_reducido, M, MPI_LONG_LONG, MPI_SUM, 0, comm_cart);
+    double t5 = MPI_Wtime();
+
+    /*
+       Comprobación exacta: suma(filas) = suma(columnas) = suma(A) y
+       suma(y) = sum_j (suma de la columna j) · x_j. Cada término lo aportan
+       solo los procesos que tienen el resultado correspondiente
+    */
+    long long control[4] = { 0, 0, 0, 0 }, control_total[4];
+    if (coords[1] == 0) {
+        for (int i = 0; i < filas; i++) {
+            control[0] += total_filas[i];
+            control[2] += y[i];
+        }
+    }
+    if (coords[0] == 0) {
+        for (int j = 0; j < columnas; j++) {
+            control[1] += total_columnas[j];
+            control[3] += total_columnas[j] * x[j];
+        }
+    }
+    MPI_Reduce(control, control_total, 4, MPI_LONG_LONG, MPI_SUM, 0, comm_cart);
+    double tiempos[4] = { t1 - t0, t2 - t1, t3 - t2, t5 - t4 }, maximos[4];
+    MPI_Reduce(tiempos, maximos, 4, MPI_DOUBLE, MPI_MAX, 0, comm_cart);
+
+    if (mirango == 0) {
+        long long referencia = 0;
+        for (int i = 0; i < M; i++) referencia += vector_reducido[i];
+        int correcto = control_total[0] == control_total[1] && control_total[2] == control_total[3] &&
+            referencia == control_total[0];
+        printf("================================================================================\n");
+        printf("  AGREGADOS POR FILAS Y COLUMNAS CON MPI_Cart_sub\n");
+        printf("================================================================================\n");
+        printf("  - Matriz %d × %d, malla %d × %d\n", M, N, dims[0], dims[1]);
+        printf("  - Procesos por reduccion: %d (filas) y %d (columnas) frente a %d\n",
+            dims[1], dims[0], numprocs);
+        printf("Tiempos (proceso mas lento):\n");
+        printf("  - Suma de filas por comm_fila:        %10.2f us\n", maximos[0] * 1e6);
+        printf("  - Suma de columnas por comm_columna:  %10.2f us\n", maximos[1] * 1e6);
+        printf("  - y = A·x (Allreduce por comm_fila):  %10.2f us\n", maximos[2] * 1e6);
+        printf("  - Suma de filas al proceso 0:         %10.2f us (vector de %d por comm_cart)\n",
+            maximos[3] * 1e6, M);
+        printf("Comprobacion: suma(A) = %lld por filas, %lld por columnas; suma(y) = %lld, esperado %lld -> %s\n",
+            control_total[0], control_total[1], control_total[2], control_total[3], correcto ? "OK" : "ERROR");
+        printf("================================================================================\n");
+    }
+
+    free(A); free(x); free(suma_filas); free(suma_columnas); free(y);
+    free(total_filas); free(total_columnas); free(vector_global); free(vector_reducido);
+    MPI_Comm_free(&comm_fila);
+    MPI_Comm_free(&comm_columna);
+    MPI_Comm_free(&comm_cart);
+}
 
 int main(int argc, char* argv[]) {
     int mirango, numprocs;
-    int FILAS, COLUMNAS;              // Dimensiones dinámicas de las matrices
+    int FILAS = 0, COLUMNAS = 0;      // Dimensiones de las matrices (M × N)
     int ndims = 2;                    // Topología 2D (filas y columnas)
-    int dims[2];                      // Dimensiones de la topología cartesiana (se definirán después)
+    int dims[2] = { 0, 0 };           // Dimensiones de la topología cartesiana (pr × pc)
     int periods[2] = { 0, 0 };          // No periódica en ninguna dimensión
     int reorder = 1;                  // Permitir reordenamiento de procesos
     int coords[2];                    // Coordenadas cartesianas [fila][columna]
 
     MPI_Comm comm_cart;               // Comunicador con topología cartesiana
 
-    // Punteros para matrices dinámicas
-    int** matrizA = NULL;
-    int** matrizB = NULL;
-    int** matrizC = NULL;
-
-    // Elementos locales de cada proceso
-    int elemento_A, elemento_B, elemento_C;
+    // Matrices completas con relleno, guardadas por filas (solo en el proceso 0)
+    int* matrizA = NULL;
+    int* matrizB = NULL;
+    int* matrizC = NULL;
 
     double tiempo_inicio, tiempo_fin;
 
@@ -56,6 +1413,32 @@ int main(int argc, char* argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
     MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
 
+    if (argc > 1 && strcmp(argv[1], "jacobi") == 0) {
+        ejecutar_jacobi(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "halo") == 0) {
+        ejecutar_halo(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "producto") == 0) {
+        ejecutar_producto(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "escalado") == 0) {
+        ejecutar_escalado(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "agregados") == 0) {
+        ejecutar_agregados(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+
     // =========================================================================
     // FASE 2: SOLICITAR DIMENSIONES DE LAS MATRICES (PROCESO 0)
     // =========================================================================
@@ -65,15 +1448,22 @@ int main(int argc, char* argv[]) {
         printf("================================================================================\n\n");
         printf("Numero de procesos disponibles: %d\n\n", numprocs);
 
+        // Las dimensiones pueden venir como argumentos (N = M si solo se da M);
+        // si no, se piden
+        if (argc > 1) {
+            FILAS = atoi(argv[1]);
+            COLUMNAS = argc > 2 ? atoi(argv[2]) : FILAS;
+        }
+
         // Bucle de validación para obtener dimensiones válidas
-        int dimensiones_validas = 0;
-        while (!dimensiones_validas) {
+        while (FILAS <= 0 || COLUMNAS <= 0) {
             printf("Introduce el numero de FILAS (M): ");
             fflush(stdout);
 
             if (scanf_s("%d", &FILAS) != 1 || FILAS <= 0) {
                 while (getchar() != '\n'); // Limpiar buffer
                 printf("ERROR: Debes introducir un numero entero positivo.\n\n");
+                FILAS = 0;
                 continue;
             }
 
@@ -83,31 +1473,39 @@ int main(int argc, char* argv[]) {
             if (scanf_s("%d", &COLUMNAS) != 1 || COLUMNAS <= 0) {
                 while (getchar() != '\n'); // Limpiar buffer
                 printf("ERROR: Debes introducir un numero entero positivo.\n\n");
+                COLUMNAS = 0;
                 continue;
             }
-
-            // Validar que el producto sea igual al número de procesos
-            if (FILAS * COLUMNAS != numprocs) {
-                printf("\nERROR: El producto %d × %d = %d no coincide con el numero de procesos (%d)\n",
-                    FILAS, COLUMNAS, FILAS * COLUMNAS, numprocs);
-                printf("Intentalo de nuevo.\n\n");
-            }
-            else {
-                dimensiones_validas = 1;
-            }
         }
 
-        printf("\nDimensiones aceptadas: %d × %d = %d procesos\n\n",
-            FILAS, COLUMNAS, FILAS * COLUMNAS);
+        printf("\nDimensiones aceptadas: %d × %d\n\n", FILAS, COLUMNAS);
     }
 
     // Difundir las dimensiones a todos los procesos
     MPI_Bcast(&FILAS, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&COLUMNAS, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    // Configurar dimensiones de la topología cartesiana
-    dims[0] = FILAS;
-    dims[1] = COLUMNAS;
+    // Semilla global (tercer argumento o reloj): cada proceso puede generar sus
+    // propios elementos con ella y el resultado no depende de quién los genere
+    semilla_t semilla = 0;
+    if (mirango == 0) {
+        semilla = argc > 3 ? strtoull(argv[3], NULL, 10) : aleatorio_semilla_reloj();
+    }
+    MPI_Bcast(&semilla, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+    semilla_t semillaA = aleatorio_flujo(semilla, 0);
+    semilla_t semillaB = aleatorio_flujo(semilla, 1);
+
+    // Generación (cuarto argumento):
+    //  - raiz (por defecto): el proceso 0 genera A y B y reparte las teselas
+    //  - local: cada proceso genera su propia tesela
+    int generacion_local = argc > 4 && strcmp(argv[4], "local") == 0;
+
+    // Configurar dimensiones de la topología cartesiana según la forma de las
+    // matrices; todos los procesos llegan a la misma malla. Como referencia se
+    // guarda la malla "cuadrada" que daría MPI_Dims_create por sí solo
+    int dims_cuadrada[2] = { 0, 0 };
+    MPI_Dims_create(numprocs, ndims, dims_cuadrada);
+    elegir_malla(numprocs, FILAS, COLUMNAS, dims);
 
     // =========================================================================
     // FASE 3: CREACIÓN DE LA TOPOLOGÍA CARTESIANA
@@ -116,15 +1514,19 @@ int main(int argc, char* argv[]) {
        MPI_Cart_create: Crea un nuevo comunicador con topología cartesiana
        - MPI_COMM_WORLD: Comunicador original
        - ndims: Número de dimensiones (2 para matriz 2D)
-       - dims: Array con el tamaño de cada dimensión [FILAS, COLUMNAS]
+       - dims: Array con el tamaño de cada dimensión [pr, pc]
        - periods: Array indicando si cada dimensión es periódica (0=no, 1=sí)
        - reorder: Permite a MPI reordenar los procesos para optimización
        - comm_cart: Nuevo comunicador cartesiano creado
     */
     MPI_Cart_create(MPI_COMM_WORLD, ndims, dims, periods, reorder, &comm_cart);
 
-    // Obtener el nuevo rango en el comunicador cartesiano
+    // Obtener el nuevo rango en el comunicador cartesiano y contar cuántos
+    // procesos ha recolocado MPI al reordenar
+    int rango_mundo = mirango;
     MPI_Comm_rank(comm_cart, &mirango);
+    int recolocado = rango_mundo != mirango, recolocados = 0;
+    MPI_Reduce(&recolocado, &recolocados, 1, MPI_INT, MPI_SUM, 0, comm_cart);
 
     // =========================================================================
     // FASE 4: OBTENER COORDENADAS CARTESIANAS DE CADA PROCESO
@@ -137,163 +1539,189 @@ int main(int argc, char* argv[]) {
        - coords: Array donde se almacenan las coordenadas [fila, columna]
 
        Ejemplo con 4×2 procesos:
-       Rango 0 → coords[0]=0, coords[1]=0 → posición [0][0]
-       Rango 1 → coords[0]=0, coords[1]=1 → posición [0][1]
-       Rango 2 → coords[0]=1, coords[1]=0 → posición [1][0]
+       Rango 0 → coords[0]=0, coords[1]=0 → tesela [0][0]
+       Rango 1 → coords[0]=0, coords[1]=1 → tesela [0][1]
+       Rango 2 → coords[0]=1, coords[1]=0 → tesela [1][0]
        ...
     */
     MPI_Cart_coords(comm_cart, mirango, ndims, coords);
 
+    /*
+       Tamaño de tesela: ceil(M/pr) × ceil(N/pc). Las matrices del proceso 0
+       se rellenan hasta (pr·filas_tesela) × (pc·columnas_tesela) para que
+       todas las teselas tengan la misma forma.
+    */
+    int filas_tesela = (FILAS + dims[0] - 1) / dims[0];
+    int columnas_tesela = (COLUMNAS + dims[1] - 1) / dims[1];
+    int filas_relleno = filas_tesela * dims[0];
+    int columnas_relleno = columnas_tesela * dims[1];
+    int elementos_tesela_total = filas_tesela * columnas_tesela;
+
+    // Parte útil de la tesela propia (sin relleno) y su origen en la matriz
+    int fila_inicio = coords[0] * filas_tesela;
+    int columna_inicio = coords[1] * columnas_tesela;
+    int mis_filas = elementos_tesela(FILAS, filas_tesela, coords[0]);
+    int mis_columnas = elementos_tesela(COLUMNAS, columnas_tesela, coords[1]);
+
+    /*
+       Tipo derivado para una tesela dentro de la matriz con relleno. Se
+       redimensiona su extensión al ancho de una tesela (columnas_tesela
+       enteros) para que los desplazamientos de Scatterv/Gatherv se cuenten en
+       anchos de tesela: la tesela (i,j) empieza en i·filas_tesela·dims[1] + j.
+       Contados en elementos desbordarían un int con matrices de más de
+       INT_MAX elementos; así dependen solo de la malla de teselas.
+    */
+    int tamanos[2] = { filas_relleno, columnas_relleno };
+    int subtamanos[2] = { filas_tesela, columnas_tesela };
+    int origen[2] = { 0, 0 };
+    MPI_Datatype tipo_subarray, tipo_tesela;
+    MPI_Type_create_subarray(2, tamanos, subtamanos, origen, MPI_ORDER_C, MPI_INT, &tipo_subarray);
+    MPI_Type_create_resized(tipo_subarray, 0, (MPI_Aint)columnas_tesela * sizeof(int), &tipo_tesela);
+    MPI_Type_commit(&tipo_tesela);
+    MPI_Type_free(&tipo_subarray);
+
+    // Teselas locales de A, B y C (por filas, con relleno a cero)
+    int* teselaA = (int*)calloc(elementos_tesela_total, sizeof(int));
+    int* teselaB = (int*)calloc(elementos_tesela_total, sizeof(int));
+    int* teselaC = (int*)calloc(elementos_tesela_total, sizeof(int));
+    if (teselaA == NULL || teselaB == NULL || teselaC == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para la tesela.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
     // =========================================================================
     // FASE 5: PROCESO 0 INICIALIZA LAS MATRICES (RESERVA DINÁMICA)
     // =========================================================================
+    int* contadores = NULL;
+    int* desplazamientos = NULL;
     if (mirango == 0) {
-        // Reservar memoria dinámica para las matrices
-        matrizA = (int**)malloc(FILAS * sizeof(int*));
-        matrizB = (int**)malloc(FILAS * sizeof(int*));
-        matrizC = (int**)malloc(FILAS * sizeof(int*));
+        // Reservar memoria contigua para las matrices con relleno
+        size_t elementos = (size_t)filas_relleno * columnas_relleno;
+        matrizA = (int*)calloc(elementos, sizeof(int));
+        matrizB = (int*)calloc(elementos, sizeof(int));
+        matrizC = (int*)calloc(elementos, sizeof(int));
+        contadores = (int*)malloc(numprocs * sizeof(int));
+        desplazamientos = (int*)malloc(numprocs * sizeof(int));
+        if (matrizA == NULL || matrizB == NULL || matrizC == NULL ||
+            contadores == NULL || desplazamientos == NULL) {
+            fprintf(stderr, "ERROR: No se pudo asignar memoria para las matrices.\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
 
-        for (int i = 0; i < FILAS; i++) {
-            matrizA[i] = (int*)malloc(COLUMNAS * sizeof(int));
-            matrizB[i] = (int*)malloc(COLUMNAS * sizeof(int));
-            matrizC[i] = (int*)malloc(COLUMNAS * sizeof(int));
+        // Una tesela por proceso, colocada según sus coordenadas
+        for (int rango = 0; rango < numprocs; rango++) {
+            int c[2];
+            MPI_Cart_coords(comm_cart, rango, ndims, c);
+            contadores[rango] = 1;
+            desplazamientos[rango] = c[0] * filas_tesela * dims[1] + c[1];
         }
 
         printf("Configuracion:\n");
         printf("  - Numero de procesos: %d\n", numprocs);
-        printf("  - Topologia: %d filas × %d columnas\n", FILAS, COLUMNAS);
-        printf("  - Dimensiones periodicas: NO\n\n");
-
-        // Inicializar generador de números aleatorios
-        srand((unsigned int)time(NULL));
-
-        // Inicializar Matriz A con valores aleatorios entre 1 y 10
-        printf("Matriz A:\n");
-        for (int i = 0; i < FILAS; i++) {
-            printf("  ");
-            for (int j = 0; j < COLUMNAS; j++) {
-                matrizA[i][j] = (int)(rand() % 10 + 1);
-                printf("%d ", matrizA[i][j]);
-            }
-            printf("\n");
+        printf("  - Topologia: %d filas × %d columnas de procesos (elegida por perimetro)\n", dims[0], dims[1]);
+        printf("  - Teselas de %d × %d elementos, perimetro %d\n", filas_tesela, columnas_tesela,
+            2 * (filas_tesela + columnas_tesela));
+        printf("  - Volumen de un intercambio de bordes: %lld elementos\n", volumen_halo(FILAS, COLUMNAS, dims));
+        if (dims[0] != dims_cuadrada[0] || dims[1] != dims_cuadrada[1]) {
+            printf("    (con la malla %d × %d de MPI_Dims_create serian %lld)\n",
+                dims_cuadrada[0], dims_cuadrada[1], volumen_halo(FILAS, COLUMNAS, dims_cuadrada));
         }
+        printf("  - Reordenacion: %d de %d procesos cambian de rango\n", recolocados, numprocs);
+        printf("  - Dimensiones periodicas: NO\n");
+        printf("  - Generacion: %s\n", generacion_local ? "local" : "raiz");
+        printf("  - Semilla: %llu\n\n", semilla);
 
-        // Inicializar Matriz B con valores aleatorios entre 1 y 10
-        printf("\nMatriz B:\n");
-        for (int i = 0; i < FILAS; i++) {
-            printf("  ");
-            for (int j = 0; j < COLUMNAS; j++) {
-                matrizB[i][j] = (int)(rand() % 10 + 1);
-                printf("%d ", matrizB[i][j]);
+        // Inicializar A y B con valores aleatorios entre 1 y 10. En modo local
+        // solo hacen falta para mostrarlas
+        if (!generacion_local || (FILAS <= N_MAX_IMPRESION && COLUMNAS <= N_MAX_IMPRESION)) {
+            for (int i = 0; i < FILAS; i++) {
+                for (int j = 0; j < COLUMNAS; j++) {
+                    unsigned long long posicion = (unsigned long long)i * COLUMNAS + j;
+                    matrizA[(size_t)i * columnas_relleno + j] = aleatorio_entero(semillaA, posicion, 1, 10);
+                    matrizB[(size_t)i * columnas_relleno + j] = aleatorio_entero(semillaB, posicion, 1, 10);
+                }
             }
-            printf("\n");
         }
-        printf("\n");
-
-        // Inicializar matriz resultado en ceros
-        for (int i = 0; i < FILAS; i++) {
-            for (int j = 0; j < COLUMNAS; j++) {
-                matrizC[i][j] = 0;
-            }
+        if (FILAS <= N_MAX_IMPRESION && COLUMNAS <= N_MAX_IMPRESION) {
+            imprimir_matriz("Matriz A:", matrizA, FILAS, COLUMNAS, columnas_relleno);
+            imprimir_matriz("Matriz B:", matrizB, FILAS, COLUMNAS, columnas_relleno);
         }
-
-        // Iniciar temporizador
-        tiempo_inicio = MPI_Wtime();
     }
 
+    // Iniciar temporizador
+    MPI_Barrier(comm_cart);
+    tiempo_inicio = MPI_Wtime();
+
     // =========================================================================
-    // FASE 6: DISTRIBUCIÓN DE ELEMENTOS A CADA PROCESO
+    // FASE 6: REPARTO O GENERACIÓN DE LAS TESELAS
     // =========================================================================
-    /*
-       Cada proceso recibe el elemento de las matrices A y B que corresponde
-       a sus coordenadas cartesianas. El proceso en (i,j) recibe A[i][j] y B[i][j].
-
-       Usamos comunicación punto a punto porque cada proceso necesita un elemento
-       diferente según su posición en la topología.
-    */
-
-    if (mirango == 0) {
-        // Proceso 0 envía elementos a todos los demás procesos
-        for (int rango_destino = 1; rango_destino < numprocs; rango_destino++) {
-            int coord_destino[2];
-
-            // Obtener las coordenadas del proceso destino
-            MPI_Cart_coords(comm_cart, rango_destino, ndims, coord_destino);
-
-            int fila = coord_destino[0];
-            int col = coord_destino[1];
-
-            // Enviar el elemento correspondiente de la matriz A
-            MPI_Send(&matrizA[fila][col], 1, MPI_INT, rango_destino, 0, comm_cart);
-
-            // Enviar el elemento correspondiente de la matriz B
-            MPI_Send(&matrizB[fila][col], 1, MPI_INT, rango_destino, 1, comm_cart);
+    if (generacion_local) {
+        /*
+           Como el generador depende solo de (semilla, posición), cada proceso
+           calcula su tesela localmente y obtiene exactamente los mismos valores
+           que habría generado el proceso 0.
+        */
+        for (int i = 0; i < mis_filas; i++) {
+            for (int j = 0; j < mis_columnas; j++) {
+                unsigned long long posicion =
+                    (unsigned long long)(fila_inicio + i) * COLUMNAS + columna_inicio + j;
+                teselaA[i * columnas_tesela + j] = aleatorio_entero(semillaA, posicion, 1, 10);
+                teselaB[i * columnas_tesela + j] = aleatorio_entero(semillaB, posicion, 1, 10);
+            }
         }
-
-        // Proceso 0 toma sus propios elementos (posición [0][0])
-        elemento_A = matrizA[0][0];
-        elemento_B = matrizB[0][0];
     }
     else {
-        // Los demás procesos reciben sus elementos
-        MPI_Recv(&elemento_A, 1, MPI_INT, 0, 0, comm_cart, MPI_STATUS_IGNORE);
-        MPI_Recv(&elemento_B, 1, MPI_INT, 0, 1, comm_cart, MPI_STATUS_IGNORE);
+        // Un MPI_Scatterv por matriz: el proceso 0 envía una tesela (tipo
+        // subarray) a cada proceso, que la recibe como enteros contiguos
+        MPI_Scatterv(matrizA, contadores, desplazamientos, tipo_tesela,
+            teselaA, elementos_tesela_total, MPI_INT, 0, comm_cart);
+        MPI_Scatterv(matrizB, contadores, desplazamientos, tipo_tesela,
+            teselaB, elementos_tesela_total, MPI_INT, 0, comm_cart);
     }
 
     // =========================================================================
     // FASE 7: CADA PROCESO CALCULA SU SUMA LOCAL
     // =========================================================================
     /*
-       Cálculo paralelo: Cada proceso suma los elementos que recibió
-       El proceso en coordenadas (i,j) calcula: C[i][j] = A[i][j] + B[i][j]
+       Cálculo paralelo: Cada proceso suma su tesela completa (el relleno son
+       ceros y no afecta): C[i][j] = A[i][j] + B[i][j]
     */
-    elemento_C = elemento_A + elemento_B;
+    for (int k = 0; k < elementos_tesela_total; k++) {
+        teselaC[k] = teselaA[k] + teselaB[k];
+    }
 
     // =========================================================================
     // FASE 8: MOSTRAR CÁLCULOS DE FORMA ORDENADA
     // =========================================================================
-    // Sincronizar para imprimir en orden por coordenadas
-    for (int fila = 0; fila < FILAS; fila++) {
-        for (int col = 0; col < COLUMNAS; col++) {
-            if (coords[0] == fila && coords[1] == col) {
-                printf("[Proceso %d - Coords(%d,%d)] %d + %d = %d\n",
-                    mirango, coords[0], coords[1],
-                    elemento_A, elemento_B, elemento_C);
-                fflush(stdout);
+    /*
+       En comm_cart los rangos siguen el orden por filas de las coordenadas,
+       así que basta reunir las líneas por rango en el proceso 0 (un
+       MPI_Gatherv en lugar de una barrera por proceso).
+       Con MPI_VERBOSIDAD=0 no se imprime nada y no hay comunicación.
+    */
+    SalidaOrdenada salida;
+    salida_iniciar(&salida, comm_cart, SALIDA_ELEMENTOS);
+    salida_printf(&salida, SALIDA_PROCESOS, "[Proceso %d - Coords(%d,%d)] filas [%d, %d) columnas [%d, %d)\n",
+        mirango, coords[0], coords[1],
+        fila_inicio, fila_inicio + mis_filas, columna_inicio, columna_inicio + mis_columnas);
+    if (FILAS <= N_MAX_IMPRESION && COLUMNAS <= N_MAX_IMPRESION) {
+        for (int i = 0; i < mis_filas; i++) {
+            for (int j = 0; j < mis_columnas; j++) {
+                int k = i * columnas_tesela + j;
+                salida_printf(&salida, SALIDA_ELEMENTOS, "    C[%d][%d]: %d + %d = %d\n",
+                    fila_inicio + i, columna_inicio + j, teselaA[k], teselaB[k], teselaC[k]);
             }
-            MPI_Barrier(comm_cart);
         }
     }
+    salida_volcar(&salida, stdout);
+    salida_liberar(&salida);
 
     // =========================================================================
     // FASE 9: RECOLECTAR RESULTADOS EN EL PROCESO 0
     // =========================================================================
-    if (mirango == 0) {
-        // Proceso 0 coloca su resultado
-        matrizC[0][0] = elemento_C;
-
-        // Recibir resultados de los demás procesos
-        for (int rango_origen = 1; rango_origen < numprocs; rango_origen++) {
-            int coord_origen[2];
-            int resultado;
-
-            // Obtener coordenadas del proceso origen
-            MPI_Cart_coords(comm_cart, rango_origen, ndims, coord_origen);
-
-            int fila = coord_origen[0];
-            int col = coord_origen[1];
-
-            // Recibir el resultado
-            MPI_Recv(&resultado, 1, MPI_INT, rango_origen, 2, comm_cart, MPI_STATUS_IGNORE);
-
-            // Almacenar en la matriz resultado
-            matrizC[fila][col] = resultado;
-        }
-    }
-    else {
-        // Los demás procesos envían su resultado
-        MPI_Send(&elemento_C, 1, MPI_INT, 0, 2, comm_cart);
-    }
+    // Cada tesela vuelve a su sitio dentro de C con el mismo tipo subarray
+    MPI_Gatherv(teselaC, elementos_tesela_total, MPI_INT,
+        matrizC, contadores, desplazamientos, tipo_tesela, 0, comm_cart);
 
     // =========================================================================
     // FASE 10: PROCESO 0 MUESTRA EL RESULTADO FINAL
@@ -302,36 +1730,67 @@ int main(int argc, char* argv[]) {
         // Finalizar temporizador
         tiempo_fin = MPI_Wtime();
 
-        printf("\n================================================================================\n");
-        printf("MATRIZ RESULTADO (C = A + B):\n");
-        printf("================================================================================\n");
+        if (FILAS <= N_MAX_IMPRESION && COLUMNAS <= N_MAX_IMPRESION) {
+            printf("\n================================================================================\n");
+            printf("MATRIZ RESULTADO (C = A + B):\n");
+            printf("================================================================================\n");
+            imprimir_matriz("", matrizC, FILAS, COLUMNAS, columnas_relleno);
+        }
+
+        // Suma de control ponderada por posición (por filas), comparable entre
+        // ejecuciones con distinto número de procesos
+        unsigned long long control = 0;
         for (int i = 0; i < FILAS; i++) {
-            printf("  ");
             for (int j = 0; j < COLUMNAS; j++) {
-                printf("%d ", matrizC[i][j]);
+                unsigned long long posicion = (unsigned long long)i * COLUMNAS + j;
+                control += (unsigned long long)matrizC[(size_t)i * columnas_relleno + j] * (posicion + 1);
             }
-            printf("\n");
         }
-        printf("\n================================================================================\n");
+        printf("================================================================================\n");
+        printf("Suma de control de C: %llu\n", control);
         printf("Tiempo de ejecucion: %.6f segundos\n", tiempo_fin - tiempo_inicio);
         printf("================================================================================\n");
     }
 
     // =========================================================================
-    // FASE 11: FINALIZACIÓN Y LIBERACIÓN DE MEMORIA
+    // FASE 11: GUARDAR C EN FORMATO BINARIO (QUINTO ARGUMENTO)
     // =========================================================================
-    if (mirango == 0) {
-        // Liberar memoria dinámica
-        for (int i = 0; i < FILAS; i++) {
-            free(matrizA[i]);
-            free(matrizB[i]);
-            free(matrizC[i]);
+    /*
+       La vista de cada proceso es un subarray de la matriz global de M×N (sin
+       relleno) y en memoria se toma la parte útil de la tesela, con distancia
+       columnas_tesela entre filas. Las teselas vacías del borde no escriben.
+    */
+    if (argc > 5) {
+        MPI_Info pistas = pistas_cargar(comm_cart);
+        uint64_t suma_fichero = 0;
+        double t0 = MPI_Wtime();
+        int resultado = matriz_escribir(comm_cart, argv[5], pistas, MATRIZ_ENTERO, FILAS, COLUMNAS,
+            MATRIZ_TESELAS, dims, teselaC,
+            matriz_tesela(fila_inicio, columna_inicio, mis_filas, mis_columnas, columnas_tesela), &suma_fichero);
+        double t1 = MPI_Wtime();
+        if (mirango == 0) {
+            printf("Matriz C guardada en '%s' (%.3f MB en %.6f segundos, suma de control %llu): %s\n",
+                argv[5], (MATRIZ_DATOS + (double)FILAS * COLUMNAS * sizeof(int)) / 1e6, t1 - t0,
+                (unsigned long long)suma_fichero, matriz_mensaje(resultado));
         }
-        free(matrizA);
-        free(matrizB);
-        free(matrizC);
+        MPI_Info_free(&pistas);
     }
 
+    // =========================================================================
+    // FASE 12: FINALIZACIÓN Y LIBERACIÓN DE MEMORIA
+    // =========================================================================
+    MPI_Type_free(&tipo_tesela);
+    free(teselaA);
+    free(teselaB);
+    free(teselaC);
+    // Liberar memoria dinámica (solo reservada en el proceso 0)
+    free(matrizA);
+    free(matrizB);
+    free(matrizC);
+    free(contadores);
+    free(desplazamientos);
+    MPI_Comm_free(&comm_cart);
+
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
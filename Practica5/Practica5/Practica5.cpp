@@ -3,14 +3,756 @@
   Universidad de Burgos - Escuela Politcnica Superior
   Grado en Ingeniera Informtica
   Arquitectura Paralela con MPI
+
+  Uso: mpiexec -n P Practica5.exe [bytes_por_proceso] [independiente|colectiva]
+  - bytes_por_proceso: tamao del bloque de cada proceso (por defecto
+    REPETICIONES); admite sufijos K, M y G y puede superar los 2 GB
+  - independiente: MPI_File_write_at / MPI_File_read_at
+  - colectiva: MPI_File_write_at_all / MPI_File_read_at_all, que permiten a
+    MPI agrupar las peticiones de todos los procesos en accesos grandes y
+    contiguos (collective buffering)
+
+  Banco de pruebas de ancho de banda:
+    mpiexec -n P Practica5.exe rendimiento [bloque] [total] [contiguo|estridado|intercalado]
+        [independiente|colectiva] [compartido|por_proceso] [repeticiones]
+  - bloque: bytes por llamada de escritura/lectura (por defecto 1M)
+  - total: bytes entre todos los procesos (por defecto 256M)
+  - compartido: un nico fichero; por_proceso: un fichero por proceso
+  Para cada repeticin imprime en CSV las fases de escritura y lectura con el
+  tiempo de apertura, transferencia y cierre del proceso ms lento y el ancho
+  de banda agregado. La lectura justo despus de la escritura puede servirse
+  desde la cach de pginas del sistema operativo si el total cabe en memoria.
+
+  Escritura asncrona solapada con clculo:
+    mpiexec -n P Practica5.exe tuberia [bloque] [bloques] [independiente|colectiva] [trabajo]
+  Cada proceso calcula 'bloques' bloques de doubles y los escribe en su
+  segmento del fichero. Se compara calcular y escribir cada bloque con
+  llamadas bloqueantes frente a una tubera con doble buffer: mientras
+  MPI_File_iwrite_at(_all) escribe el bloque k se calcula el k+1 en el otro
+  buffer. 'trabajo' fija el coste del clculo por elemento.
+
+  Lectura de matrices en formato binario (Comun/matriz_binaria.h):
+    mpiexec -n P Practica5.exe matriz fichero.mat
+  Lee un fichero guardado por las prcticas 2, 4 o 7 con cualquier nmero de
+  procesos (cada uno un bloque de filas, sea cual sea el reparto con el que
+  se escribi), comprueba la suma de control y muestra la cabecera.
+
+  Anlisis de ficheros .mat proyectados en memoria (Comun/mapa_matriz.h):
+    mpiexec -n 1 Practica5.exe mapa suma fichero.mat
+    mpiexec -n 1 Practica5.exe mapa comparar a.mat b.mat [tolerancia]
+    mpiexec -n 1 Practica5.exe mapa tesela fichero.mat fila0 col0 filas columnas
+    mpiexec -n 1 Practica5.exe mapa columna fichero.mat columna
+  Solo trabaja el proceso 0, sin MPI-IO: el fichero se proyecta con mmap (o
+  MapViewOfFile) y se recorre por ventanas, as que sirve para validar
+  ficheros mayores que la memoria o comparar las salidas de dos ejecuciones.
+
+  Pistas MPI-IO (cb_buffer_size, cb_nodes, romio_cb_write, striping_factor...):
+  se toman del fichero de MPI_PISTAS_FICHERO y de la variable MPI_PISTAS
+  ("clave=valor;clave=valor"), ver Comun/pistas_es.h. Se muestran las pistas
+  efectivas que devuelve MPI_File_get_info.
 */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "salida.h"
+#include "pistas_es.h"
+#include "matriz_binaria.h"
+#include "mapa_matriz.h"
 
 #define REPETICIONES 10
+// Los contadores de MPI son int: los bloques grandes se transfieren por trozos
+#define TROZO_MAX_ES (1LL << 30)
+// Se muestran como mucho estos caracteres de lo ledo por cada proceso
+#define MAX_IMPRESION 64
+
+// Interpreta tamaos como "10", "512K", "64M" o "2G" (potencias de 1024)
+long long leer_tamano(const char* texto)
+{
+    char* fin;
+    long long valor = strtoll(texto, &fin, 10);
+    switch (*fin) {
+    case 'k': case 'K': valor <<= 10; break;
+    case 'm': case 'M': valor <<= 20; break;
+    case 'g': case 'G': valor <<= 30; break;
+    }
+    return valor;
+}
+
+/*
+   Escribe o lee 'bytes' bytes del buffer a partir del principio de la vista
+   en trozos de como mucho TROZO_MAX_ES. En modo colectivo todos los procesos
+   tienen que hacer el mismo nmero de llamadas: 'llamadas' es el mximo entre
+   procesos y quien ya ha terminado participa con 0 bytes.
+*/
+int transferir(MPI_File fh, char* buffer, long long bytes, long long llamadas,
+    int escribir, int colectiva, MPI_Status* estado)
+{
+    for (long long k = 0; k < llamadas; k++) {
+        long long inicio = k * TROZO_MAX_ES;
+        if (inicio > bytes) inicio = bytes;
+        int cantidad = (int)(bytes - inicio < TROZO_MAX_ES ? bytes - inicio : TROZO_MAX_ES);
+        int resultado;
+        if (escribir) {
+            resultado = colectiva
+                ? MPI_File_write_at_all(fh, inicio, buffer + inicio, cantidad, MPI_CHAR, estado)
+                : MPI_File_write_at(fh, inicio, buffer + inicio, cantidad, MPI_CHAR, estado);
+        }
+        else {
+            resultado = colectiva
+                ? MPI_File_read_at_all(fh, inicio, buffer + inicio, cantidad, MPI_CHAR, estado)
+                : MPI_File_read_at(fh, inicio, buffer + inicio, cantidad, MPI_CHAR, estado);
+        }
+        if (resultado != MPI_SUCCESS) {
+            return resultado;
+        }
+    }
+    return MPI_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// BANCO DE PRUEBAS DE ENTRADA/SALIDA
+// ---------------------------------------------------------------------------
+
+#define BANCO_BLOQUE_DEFECTO (1LL << 20)
+#define BANCO_TOTAL_DEFECTO (256LL << 20)
+#define BANCO_REPETICIONES 3
+// Granularidad del patrn intercalado (un double)
+#define BANCO_ELEMENTO 8
+
+enum { PATRON_CONTIGUO, PATRON_ESTRIDADO, PATRON_INTERCALADO };
+const char* NOMBRES_PATRON[] = { "contiguo", "estridado", "intercalado" };
+
+typedef struct {
+    long long bloque;       // Bytes por llamada (cabe en un int)
+    long long local;        // Bytes por proceso, mltiplo de 'bloque'
+    int patron;
+    int colectiva;
+    int por_proceso;        // 1: un fichero por proceso, 0: fichero compartido
+    MPI_Info pistas;        // Pistas para MPI_File_open y MPI_File_set_view
+} ConfigBanco;
+
+typedef struct {
+    double abrir;           // MPI_File_open + MPI_File_set_view
+    double transferir;      // Solo las llamadas de escritura/lectura
+    double cerrar;
+    long long erroneos;
+} TiemposFase;
+
+// Contenido del bloque k del proceso: una letra, para poder comprobar la lectura
+char caracter_bloque(int rango, long long k)
+{
+    return (char)('A' + (rango + k) % 26);
+}
+
+/*
+   Fija la vista del patrn pedido. En los tres casos cada proceso ve sus datos
+   como bytes contiguos y transfiere el bloque k en la posicin k*bloque de la
+   vista; lo que cambia es dnde caen dentro del fichero:
+    - contiguo: un segmento de 'local' bytes por proceso, uno tras otro
+    - estridado: bloques por turnos, el bloque k del proceso r en la posicin
+      (k*P + r)*bloque
+    - intercalado: igual pero con elementos de 8 bytes, como una columna de
+      doubles repartida de forma cclica; es el peor caso para la E/S
+      independiente y donde ms ayuda la colectiva
+   El tipo de fichero describe una sola vuelta y la vista lo repite.
+*/
+int vista_patron(MPI_File fh, int patron, long long bloque, long long local, int rango, int procesos,
+    MPI_Info pistas)
+{
+    if (procesos == 1 || patron == PATRON_CONTIGUO) {
+        return MPI_File_set_view(fh, (MPI_Offset)rango * local, MPI_BYTE, MPI_BYTE,
+            (char*)"native", pistas);
+    }
+    long long trozo = patron == PATRON_ESTRIDADO ? bloque : BANCO_ELEMENTO;
+    MPI_Datatype tipo, tipo_fichero;
+    MPI_Type_contiguous((int)trozo, MPI_BYTE, &tipo);
+    MPI_Type_create_resized(tipo, 0, (MPI_Aint)trozo * procesos, &tipo_fichero);
+    MPI_Type_commit(&tipo_fichero);
+    MPI_Type_free(&tipo);
+    int resultado = MPI_File_set_view(fh, (MPI_Offset)rango * trozo, MPI_BYTE, tipo_fichero,
+        (char*)"native", pistas);
+    MPI_Type_free(&tipo_fichero);
+    return resultado;
+}
+
+/*
+   Una fase (escritura o lectura) del banco de pruebas sobre 'comm', que es
+   MPI_COMM_WORLD con fichero compartido o MPI_COMM_SELF con uno por proceso.
+   Solo se cronometran las llamadas de E/S: el relleno y la comprobacin del
+   buffer quedan fuera.
+*/
+TiemposFase fase_banco(const ConfigBanco* c, MPI_Comm comm, const char* nombre, int escribir, char* buffer)
+{
+    int mirango, rango, procesos;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_rank(comm, &rango);
+    MPI_Comm_size(comm, &procesos);
+    TiemposFase t = { 0.0, 0.0, 0.0, 0 };
+    MPI_File fh;
+    MPI_Status estado;
+    long long bloques = c->local / c->bloque;
+    int cantidad = (int)c->bloque;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double inicio = MPI_Wtime();
+    int modo = escribir ? MPI_MODE_CREATE | MPI_MODE_WRONLY : MPI_MODE_RDONLY;
+    int resultado = MPI_File_open(comm, nombre, modo, c->pistas, &fh);
+    if (resultado == MPI_SUCCESS) {
+        resultado = vista_patron(fh, c->patron, c->bloque, c->local, rango, procesos, c->pistas);
+    }
+    if (resultado != MPI_SUCCESS) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo abrir '%s'.\n", mirango, nombre);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    t.abrir = MPI_Wtime() - inicio;
+
+    for (long long k = 0; k < bloques; k++) {
+        MPI_Offset posicion = (MPI_Offset)k * c->bloque;
+        char esperado = caracter_bloque(mirango, k);
+        if (escribir) {
+            memset(buffer, esperado, (size_t)c->bloque);
+        }
+        double t0 = MPI_Wtime();
+        if (escribir) {
+            resultado = c->colectiva
+                ? MPI_File_write_at_all(fh, posicion, buffer, cantidad, MPI_BYTE, &estado)
+                : MPI_File_write_at(fh, posicion, buffer, cantidad, MPI_BYTE, &estado);
+        }
+        else {
+            resultado = c->colectiva
+                ? MPI_File_read_at_all(fh, posicion, buffer, cantidad, MPI_BYTE, &estado)
+                : MPI_File_read_at(fh, posicion, buffer, cantidad, MPI_BYTE, &estado);
+        }
+        t.transferir += MPI_Wtime() - t0;
+        if (resultado != MPI_SUCCESS) {
+            fprintf(stderr, "[Proceso %d] ERROR: Fallo en la %s de '%s'.\n", mirango,
+                escribir ? "escritura" : "lectura", nombre);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if (!escribir) {
+            for (long long j = 0; j < c->bloque; j++) {
+                if (buffer[j] != esperado) t.erroneos++;
+            }
+        }
+    }
+
+    double t0 = MPI_Wtime();
+    MPI_File_close(&fh);
+    t.cerrar = MPI_Wtime() - t0;
+    return t;
+}
+
+// Rene en la raz los tiempos del proceso ms lento y escribe la fila CSV
+void informar_fase(const ConfigBanco* c, int repeticion, const char* fase, TiemposFase t)
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    double tiempos[3] = { t.abrir, t.transferir, t.cerrar }, maximos[3];
+    struct { double tiempo; int rango; } propio, lento;
+    long long erroneos;
+    propio.tiempo = t.abrir + t.transferir + t.cerrar;
+    propio.rango = mirango;
+    MPI_Reduce(tiempos, maximos, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&propio, &lento, 1, MPI_DOUBLE_INT, MPI_MAXLOC, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&t.erroneos, &erroneos, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (mirango == 0) {
+        double megas = (double)c->local * numprocs / (1024.0 * 1024.0);
+        printf("%d,%s,%s,%s,%s,%d,%lld,%.1f,%.6f,%.6f,%.6f,%.6f,%d,%.2f,%.2f,%s\n",
+            repeticion, fase, NOMBRES_PATRON[c->patron], c->colectiva ? "colectiva" : "independiente",
+            c->por_proceso ? "por_proceso" : "compartido", numprocs, c->bloque, megas,
+            maximos[0], maximos[1], maximos[2], lento.tiempo, lento.rango,
+            megas / maximos[1], megas / lento.tiempo,
+            strcmp(fase, "lectura") != 0 ? "-" : (erroneos == 0 ? "OK" : "ERROR"));
+        fflush(stdout);
+    }
+}
+
+void ejecutar_rendimiento(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    ConfigBanco c;
+    c.bloque = argc > 2 ? leer_tamano(argv[2]) : BANCO_BLOQUE_DEFECTO;
+    long long total = argc > 3 ? leer_tamano(argv[3]) : BANCO_TOTAL_DEFECTO;
+    c.patron = PATRON_CONTIGUO;
+    for (int p = 0; p < 3; p++) {
+        if (argc > 4 && strcmp(argv[4], NOMBRES_PATRON[p]) == 0) c.patron = p;
+    }
+    c.colectiva = argc > 5 && strcmp(argv[5], "colectiva") == 0;
+    c.por_proceso = argc > 6 && strcmp(argv[6], "por_proceso") == 0;
+    c.pistas = pistas_cargar(MPI_COMM_WORLD);
+    int repeticiones = argc > 7 ? atoi(argv[7]) : BANCO_REPETICIONES;
+    if (repeticiones <= 0) repeticiones = 1;
+
+    // Cada proceso transfiere el mismo nmero de bloques completos
+    c.local = c.bloque > 0 ? total / numprocs / c.bloque * c.bloque : 0;
+    if (c.bloque <= 0 || c.bloque > TROZO_MAX_ES || c.local == 0
+        || (c.patron == PATRON_INTERCALADO && c.bloque % BANCO_ELEMENTO != 0)) {
+        if (mirango == 0) {
+            fprintf(stderr, "ERROR: El bloque debe estar entre 1 byte y 1G (multiplo de %d en el patron "
+                "intercalado) y el total debe dar al menos un bloque por proceso.\n", BANCO_ELEMENTO);
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    char nombre[64];
+    if (c.por_proceso) {
+        snprintf(nombre, sizeof(nombre), "banco_es.dat.%d", mirango);
+    }
+    else {
+        snprintf(nombre, sizeof(nombre), "banco_es.dat");
+    }
+    MPI_Comm comm = c.por_proceso ? MPI_COMM_SELF : MPI_COMM_WORLD;
+
+    char* buffer = (char*)malloc((size_t)c.bloque);
+    if (buffer == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para el bloque.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (mirango == 0) {
+        printf("# Banco de E/S: %d procesos, %lld bytes por proceso en bloques de %lld, %d repeticiones\n",
+            numprocs, c.local, c.bloque, repeticiones);
+        printf("repeticion,fase,patron,acceso,ficheros,procesos,bloque,total_MB,abrir_s,transferir_s,"
+            "cerrar_s,lento_s,rango_lento,MB_s,MB_s_con_abrir_cerrar,comprobacion\n");
+        fflush(stdout);
+    }
+    // Pistas efectivas: se abre el fichero una vez fuera de las medidas
+    MPI_File fh;
+    if (MPI_File_open(comm, nombre, MPI_MODE_CREATE | MPI_MODE_WRONLY, c.pistas, &fh) == MPI_SUCCESS) {
+        if (mirango == 0) {
+            pistas_imprimir(fh, stdout, "# pista ");
+        }
+        MPI_File_close(&fh);
+    }
+    for (int r = 0; r < repeticiones; r++) {
+        // Partir de un fichero nuevo para no medir sobre uno ya reservado
+        if (c.por_proceso || mirango == 0) {
+            MPI_File_delete(nombre, MPI_INFO_NULL);
+        }
+        informar_fase(&c, r, "escritura", fase_banco(&c, comm, nombre, 1, buffer));
+        informar_fase(&c, r, "lectura", fase_banco(&c, comm, nombre, 0, buffer));
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (c.por_proceso || mirango == 0) {
+        MPI_File_delete(nombre, MPI_INFO_NULL);
+    }
+    MPI_Info_free(&c.pistas);
+    free(buffer);
+}
+
+// ---------------------------------------------------------------------------
+// ESCRITURA ASNCRONA CON DOBLE BUFFER
+// ---------------------------------------------------------------------------
+
+#define TUBERIA_BLOQUE_DEFECTO (8LL << 20)
+#define TUBERIA_BLOQUES_DEFECTO 16
+#define TUBERIA_TRABAJO_DEFECTO 20
+// Elementos calculados entre dos MPI_Testall, para que avance la E/S pendiente
+#define TUBERIA_PROGRESO 65536
+
+typedef struct {
+    double total;           // Desde el primer clculo hasta cerrar el fichero
+    double calculo;
+    double es;              // Bloqueado en E/S: escrituras, esperas y cierre
+    double suma;            // Suma de todo lo escrito, para la comprobacin
+} TiemposTuberia;
+
+/*
+   Calcula un bloque: cada elemento depende de su posicin global en el
+   segmento del proceso y 'trabajo' fija las operaciones por elemento. Entre
+   fragmentos se llama a MPI_Testall sobre las escrituras pendientes; muchas
+   implementaciones solo avanzan la E/S no bloqueante dentro de llamadas MPI.
+*/
+void calcular_bloque(double* bloque, long long elementos, long long primero, int trabajo,
+    MPI_Request* pendientes, int npendientes)
+{
+    for (long long i0 = 0; i0 < elementos; i0 += TUBERIA_PROGRESO) {
+        long long i1 = i0 + TUBERIA_PROGRESO < elementos ? i0 + TUBERIA_PROGRESO : elementos;
+        for (long long i = i0; i < i1; i++) {
+            double x = (double)(primero + i);
+            for (int t = 0; t < trabajo; t++) {
+                x = x * 0.999999 + 1.0;
+            }
+            bloque[i] = x;
+        }
+        if (npendientes > 0) {
+            int completadas;
+            MPI_Testall(npendientes, pendientes, &completadas, MPI_STATUSES_IGNORE);
+        }
+    }
+}
+
+/*
+   Calcula y escribe 'bloques' bloques en el segmento del proceso.
+    - tuberia = 0: cada bloque se calcula y se escribe con write_at(_all)
+    - tuberia = 1: el bloque k se calcula en el buffer k%2 y se lanza con
+      iwrite_at(_all); antes de reutilizar un buffer se espera la escritura
+      del bloque k-2 que sali de l, y al final MPI_Waitall recoge las dos
+      que quedan en vuelo
+*/
+TiemposTuberia escribir_calculado(const char* nombre, MPI_Info pistas, double* buffers[2],
+    long long elementos, int bloques, int trabajo, int colectiva, int tuberia)
+{
+    int mirango;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    TiemposTuberia t = { 0.0, 0.0, 0.0, 0.0 };
+    MPI_File fh;
+    MPI_Offset desplazamiento = (MPI_Offset)mirango * bloques * elementos * sizeof(double);
+    int resultado = MPI_File_open(MPI_COMM_WORLD, nombre, MPI_MODE_CREATE | MPI_MODE_WRONLY, pistas, &fh);
+    if (resultado == MPI_SUCCESS) {
+        resultado = MPI_File_set_view(fh, desplazamiento, MPI_DOUBLE, MPI_DOUBLE, (char*)"native", pistas);
+    }
+    if (resultado != MPI_SUCCESS) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo abrir '%s'.\n", mirango, nombre);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Request peticiones[2] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+    MPI_Barrier(MPI_COMM_WORLD);
+    double inicio = MPI_Wtime();
+    for (int k = 0; k < bloques; k++) {
+        int actual = tuberia ? k % 2 : 0;
+        double* bloque = buffers[actual];
+        double t0 = MPI_Wtime();
+        MPI_Wait(&peticiones[actual], MPI_STATUS_IGNORE);
+        double t1 = MPI_Wtime();
+        calcular_bloque(bloque, elementos, (long long)k * elementos, trabajo, peticiones, tuberia ? 2 : 0);
+        for (long long i = 0; i < elementos; i++) {
+            t.suma += bloque[i];
+        }
+        double t2 = MPI_Wtime();
+        MPI_Offset posicion = (MPI_Offset)k * elementos;
+        if (tuberia) {
+            resultado = colectiva
+                ? MPI_File_iwrite_at_all(fh, posicion, bloque, (int)elementos, MPI_DOUBLE, &peticiones[actual])
+                : MPI_File_iwrite_at(fh, posicion, bloque, (int)elementos, MPI_DOUBLE, &peticiones[actual]);
+        }
+        else {
+            resultado = colectiva
+                ? MPI_File_write_at_all(fh, posicion, bloque, (int)elementos, MPI_DOUBLE, MPI_STATUS_IGNORE)
+                : MPI_File_write_at(fh, posicion, bloque, (int)elementos, MPI_DOUBLE, MPI_STATUS_IGNORE);
+        }
+        double t3 = MPI_Wtime();
+        if (resultado != MPI_SUCCESS) {
+            fprintf(stderr, "[Proceso %d] ERROR: Fallo al escribir el bloque %d.\n", mirango, k);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        t.calculo += t2 - t1;
+        t.es += (t1 - t0) + (t3 - t2);
+    }
+    double t0 = MPI_Wtime();
+    MPI_Waitall(2, peticiones, MPI_STATUSES_IGNORE);
+    MPI_File_close(&fh);
+    double fin = MPI_Wtime();
+    t.es += fin - t0;
+    t.total = fin - inicio;
+    return t;
+}
+
+// Relee el segmento del proceso y suma sus valores en el mismo orden en que se escribieron
+double sumar_fichero(const char* nombre, MPI_Info pistas, double* buffer, long long elementos, int bloques)
+{
+    int mirango;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_File fh;
+    MPI_Offset desplazamiento = (MPI_Offset)mirango * bloques * elementos * sizeof(double);
+    int resultado = MPI_File_open(MPI_COMM_WORLD, nombre, MPI_MODE_RDONLY, pistas, &fh);
+    if (resultado == MPI_SUCCESS) {
+        resultado = MPI_File_set_view(fh, desplazamiento, MPI_DOUBLE, MPI_DOUBLE, (char*)"native", pistas);
+    }
+    double suma = 0.0;
+    for (int k = 0; k < bloques && resultado == MPI_SUCCESS; k++) {
+        resultado = MPI_File_read_at(fh, (MPI_Offset)k * elementos, buffer, (int)elementos,
+            MPI_DOUBLE, MPI_STATUS_IGNORE);
+        for (long long i = 0; i < elementos; i++) {
+            suma += buffer[i];
+        }
+    }
+    if (resultado != MPI_SUCCESS) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo releer '%s'.\n", mirango, nombre);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_close(&fh);
+    return suma;
+}
+
+void ejecutar_tuberia(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    long long bloque = argc > 2 ? leer_tamano(argv[2]) : TUBERIA_BLOQUE_DEFECTO;
+    int bloques = argc > 3 ? atoi(argv[3]) : TUBERIA_BLOQUES_DEFECTO;
+    int colectiva = argc > 4 && strcmp(argv[4], "colectiva") == 0;
+    int trabajo = argc > 5 ? atoi(argv[5]) : TUBERIA_TRABAJO_DEFECTO;
+    long long elementos = bloque / (long long)sizeof(double);
+    if (elementos <= 0 || bloque > TROZO_MAX_ES || bloques <= 0 || trabajo < 0) {
+        if (mirango == 0) {
+            fprintf(stderr, "ERROR: El bloque debe estar entre 8 bytes y 1G y debe haber al menos un bloque.\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Info pistas = pistas_cargar(MPI_COMM_WORLD);
+    const char* nombre = "tuberia.dat";
+
+    double* buffers[2];
+    buffers[0] = (double*)malloc((size_t)elementos * sizeof(double));
+    buffers[1] = (double*)malloc((size_t)elementos * sizeof(double));
+    if (buffers[0] == NULL || buffers[1] == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para los buffers.\n", mirango);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    double megas = (double)elementos * sizeof(double) * bloques * numprocs / (1024.0 * 1024.0);
+    if (mirango == 0) {
+        printf("# Escritura de bloques calculados: %d procesos, %d bloques de %lld bytes por proceso (%.1f MB), "
+            "acceso %s, trabajo %d\n", numprocs, bloques, elementos * (long long)sizeof(double), megas,
+            colectiva ? "colectivo" : "independiente", trabajo);
+        printf("modo,total_s,calculo_s,es_s,MB_s,comprobacion\n");
+    }
+    double es_secuencial = 0.0, es_tuberia = 0.0;
+    for (int tuberia = 0; tuberia <= 1; tuberia++) {
+        if (mirango == 0) {
+            MPI_File_delete(nombre, MPI_INFO_NULL);
+        }
+        TiemposTuberia t = escribir_calculado(nombre, pistas, buffers, elementos, bloques, trabajo,
+            colectiva, tuberia);
+        int correcto = sumar_fichero(nombre, pistas, buffers[0], elementos, bloques) == t.suma, todos;
+        double tiempos[3] = { t.total, t.calculo, t.es }, maximos[3];
+        MPI_Reduce(tiempos, maximos, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&correcto, &todos, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+        if (mirango == 0) {
+            printf("%s,%.6f,%.6f,%.6f,%.2f,%s\n", tuberia ? "tuberia" : "secuencial",
+                maximos[0], maximos[1], maximos[2], megas / maximos[0], todos ? "OK" : "ERROR");
+            fflush(stdout);
+        }
+        if (tuberia) {
+            es_tuberia = maximos[2];
+        }
+        else {
+            es_secuencial = maximos[2];
+        }
+    }
+    if (mirango == 0) {
+        if (es_secuencial > 0.0) {
+            printf("# E/S oculta tras el calculo: %.1f %%\n", 100.0 * (1.0 - es_tuberia / es_secuencial));
+        }
+        MPI_File_delete(nombre, MPI_INFO_NULL);
+    }
+    free(buffers[0]);
+    free(buffers[1]);
+    MPI_Info_free(&pistas);
+}
+
+// ---------------------------------------------------------------------------
+// LECTURA DE MATRICES EN FORMATO BINARIO
+// ---------------------------------------------------------------------------
+
+#define MATRIZ_MAX_IMPRESION 10
+
+void ejecutar_matriz(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    if (argc < 3) {
+        if (mirango == 0) {
+            fprintf(stderr, "Uso: mpiexec -n P Practica5.exe matriz fichero.mat\n");
+        }
+        return;
+    }
+    const char* nombre = argv[2];
+    CabeceraMatriz c;
+    int resultado = matriz_leer_cabecera(MPI_COMM_WORLD, nombre, &c);
+    if (resultado != MATRIZ_OK) {
+        if (mirango == 0) {
+            fprintf(stderr, "ERROR: '%s': %s.\n", nombre, matriz_mensaje(resultado));
+        }
+        return;
+    }
+
+    // Reparto por bloques de filas, independiente del que se us al escribir
+    int filas = (int)c.filas, columnas = (int)c.columnas;
+    int base = filas / numprocs, resto = filas % numprocs;
+    int misfilas = base + (mirango < resto ? 1 : 0);
+    int fila0 = mirango * base + (mirango < resto ? mirango : resto);
+    size_t tamano = (size_t)misfilas * columnas * matriz_tamano_elemento(c.tipo);
+    void* datos = malloc(tamano > 0 ? tamano : 1);
+    if (datos == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para %d filas.\n", mirango, misfilas);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Info pistas = pistas_cargar(MPI_COMM_WORLD);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    resultado = matriz_leer(MPI_COMM_WORLD, nombre, pistas, &c, datos,
+        matriz_tesela(fila0, 0, misfilas, columnas, columnas), 1);
+    double tiempo = MPI_Wtime() - t0;
+
+    SalidaOrdenada salida;
+    salida_iniciar(&salida, MPI_COMM_WORLD, SALIDA_ELEMENTOS);
+    if (filas <= MATRIZ_MAX_IMPRESION && columnas <= MATRIZ_MAX_IMPRESION) {
+        for (int i = 0; i < misfilas; i++) {
+            salida_printf(&salida, SALIDA_ELEMENTOS, "  ");
+            for (int j = 0; j < columnas; j++) {
+                size_t k = (size_t)i * columnas + j;
+                if (c.tipo == MATRIZ_REAL) {
+                    salida_printf(&salida, SALIDA_ELEMENTOS, "%10.4f ", ((double*)datos)[k]);
+                }
+                else {
+                    salida_printf(&salida, SALIDA_ELEMENTOS, "%4d ", ((int*)datos)[k]);
+                }
+            }
+            salida_printf(&salida, SALIDA_ELEMENTOS, "\n");
+        }
+    }
+    salida_volcar(&salida, stdout);
+    salida_liberar(&salida);
+
+    if (mirango == 0) {
+        const char* repartos[] = { "matriz completa", "bloques de filas", "teselas" };
+        double megas = (double)filas * columnas * matriz_tamano_elemento(c.tipo) / (1024.0 * 1024.0);
+        printf("Fichero: %s\n", nombre);
+        printf("  - Elementos: %s, %d  %d\n", c.tipo == MATRIZ_REAL ? "double" : "int", filas, columnas);
+        printf("  - Escrita con: %s, malla %d  %d\n",
+            c.reparto >= 0 && c.reparto <= 2 ? repartos[c.reparto] : "desconocido", c.malla[0], c.malla[1]);
+        printf("  - Suma de control: %llu\n", (unsigned long long)c.suma);
+        printf("  - Leida con %d procesos en %.6f s (%.2f MB/s): %s\n", numprocs, tiempo,
+            megas / tiempo, matriz_mensaje(resultado));
+    }
+    MPI_Info_free(&pistas);
+    free(datos);
+}
+
+// ---------------------------------------------------------------------------
+// Anlisis de ficheros .mat proyectados en memoria (solo el proceso 0)
+// ---------------------------------------------------------------------------
+
+#define MAPA_MAX_IMPRESION 16
+
+// Abre 'nombre' con mapa_abrir e informa del error; devuelve 0 si falla
+int abrir_mapa(MatrizMapeada* m, const char* nombre)
+{
+    int resultado = mapa_abrir(m, nombre);
+    if (resultado != MATRIZ_OK) {
+        fprintf(stderr, "ERROR: '%s': %s.\n", nombre, matriz_mensaje(resultado));
+        return 0;
+    }
+    return 1;
+}
+
+// Muestra una vista de como mucho MAPA_MAX_IMPRESION x MAPA_MAX_IMPRESION elementos
+void imprimir_vista(const VistaMatriz* v, int tipo)
+{
+    int filas = v->filas < MAPA_MAX_IMPRESION ? v->filas : MAPA_MAX_IMPRESION;
+    int columnas = v->columnas < MAPA_MAX_IMPRESION ? v->columnas : MAPA_MAX_IMPRESION;
+    for (int i = 0; i < filas; i++) {
+        printf("  %6d: ", v->fila0 + i);
+        for (int j = 0; j < columnas; j++) {
+            if (tipo == MATRIZ_REAL) {
+                printf("%10.4f ", mapa_valor(v, tipo, i, j));
+            }
+            else {
+                printf("%4d ", (int)mapa_valor(v, tipo, i, j));
+            }
+        }
+        printf(columnas < v->columnas ? "...\n" : "\n");
+    }
+    if (filas < v->filas) {
+        printf("  ... (%d filas ms)\n", v->filas - filas);
+    }
+}
+
+void ejecutar_mapa(int argc, char* argv[])
+{
+    int mirango;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    if (mirango != 0) {
+        return;
+    }
+    const char* orden = argc > 2 ? argv[2] : "";
+    int suma = strcmp(orden, "suma") == 0 && argc > 3;
+    int comparar = strcmp(orden, "comparar") == 0 && argc > 4;
+    int tesela = strcmp(orden, "tesela") == 0 && argc > 7;
+    int columna = strcmp(orden, "columna") == 0 && argc > 4;
+    if (!suma && !comparar && !tesela && !columna) {
+        fprintf(stderr, "Uso: Practica5.exe mapa suma fichero.mat\n"
+            "     Practica5.exe mapa comparar a.mat b.mat [tolerancia]\n"
+            "     Practica5.exe mapa tesela fichero.mat fila0 col0 filas columnas\n"
+            "     Practica5.exe mapa columna fichero.mat columna\n");
+        return;
+    }
+
+    MatrizMapeada m;
+    if (!abrir_mapa(&m, argv[3])) {
+        return;
+    }
+    const CabeceraMatriz* c = &m.cabecera;
+    double megas = (double)c->filas * c->columnas * matriz_tamano_elemento(c->tipo) / (1024.0 * 1024.0);
+    printf("Fichero: %s (%s, %lld  %lld)\n", argv[3], c->tipo == MATRIZ_REAL ? "double" : "int",
+        (long long)c->filas, (long long)c->columnas);
+
+    if (suma) {
+        int correcto;
+        double t0 = MPI_Wtime();
+        uint64_t calculada = mapa_suma(&m, &correcto);
+        double tiempo = MPI_Wtime() - t0;
+        if (!correcto) {
+            fprintf(stderr, "ERROR: No se pudo proyectar el fichero.\n");
+        }
+        else {
+            printf("  - Suma de control: %llu (cabecera: %llu): %s\n", (unsigned long long)calculada,
+                (unsigned long long)c->suma, matriz_mensaje(calculada == c->suma ? MATRIZ_OK : MATRIZ_ERROR_SUMA));
+            printf("  - Recorrido en %.6f s (%.2f MB/s)\n", tiempo, megas / tiempo);
+        }
+    }
+    else if (comparar) {
+        MatrizMapeada otra;
+        if (abrir_mapa(&otra, argv[4])) {
+            double tolerancia = argc > 5 ? atof(argv[5]) : 0.0;
+            DiferenciaMatrices d;
+            double t0 = MPI_Wtime();
+            int correcto = mapa_comparar(&m, &otra, tolerancia, &d);
+            double tiempo = MPI_Wtime() - t0;
+            if (!correcto) {
+                fprintf(stderr, "ERROR: '%s' es de %lld  %lld o no se pudo proyectar.\n", argv[4],
+                    (long long)otra.cabecera.filas, (long long)otra.cabecera.columnas);
+            }
+            else {
+                printf("  - Comparado con %s (tolerancia %g) en %.6f s (%.2f MB/s)\n", argv[4], tolerancia,
+                    tiempo, 2.0 * megas / tiempo);
+                printf("  - Elementos distintos: %lld, diferencia mxima: %g\n", d.distintos, d.maxima);
+                if (d.distintos > 0) {
+                    printf("  - Primera diferencia en (%lld, %lld)\n", d.fila, d.columna);
+                }
+            }
+            mapa_cerrar(&otra);
+        }
+    }
+    else {
+        VistaMatriz v;
+        int correcto = tesela
+            ? mapa_tesela(&m, atoi(argv[4]), atoi(argv[5]), atoi(argv[6]), atoi(argv[7]), MAPA_NORMAL, &v)
+            : mapa_columna(&m, atoi(argv[4]), &v);
+        if (!correcto) {
+            fprintf(stderr, "ERROR: La tesela se sale de la matriz o no se pudo proyectar.\n");
+        }
+        else {
+            printf("  - Tesela (%d, %d) de %d  %d, proyectados %llu bytes\n", v.fila0, v.col0, v.filas,
+                v.columnas, (unsigned long long)v.longitud);
+            imprimir_vista(&v, c->tipo);
+            mapa_liberar_vista(&v);
+        }
+    }
+    mapa_cerrar(&m);
+}
 
 int main(int argc, char* argv[]) {
     int mirango, numprocs;
@@ -20,9 +762,8 @@ int main(int argc, char* argv[]) {
 
     char nombre_fichero[] = "salida_paralela.txt";
 
-    char* buffer_escritura = NULL;
-    char* buffer_lectura = NULL;   
-    int tamanho_buffer;
+    char* buffer = NULL;           // Se reutiliza para escribir y para leer
+    long long tamanho_buffer;
 
     double tiempo_inicio = 0.0, tiempo_fin = 0.0;  // Inicializar ambos
     // INICIALIZACIN DE MPI
@@ -30,6 +771,48 @@ int main(int argc, char* argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
     MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
 
+    if (argc > 1 && strcmp(argv[1], "rendimiento") == 0) {
+        ejecutar_rendimiento(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "matriz") == 0) {
+        ejecutar_matriz(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "mapa") == 0) {
+        ejecutar_mapa(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "tuberia") == 0) {
+        ejecutar_tuberia(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Las lneas de cada proceso se renen en el proceso 0 y salen en orden
+    // de rango; con MPI_VERBOSIDAD=0 solo se imprime el resumen
+    SalidaOrdenada salida;
+    salida_iniciar(&salida, MPI_COMM_WORLD, SALIDA_ELEMENTOS);
+
+    // Pistas MPI-IO configuradas (objeto vaco si no hay ninguna)
+    MPI_Info pistas = pistas_cargar(MPI_COMM_WORLD);
+
+    // Tamao del bloque y modo de acceso (iguales en todos los procesos)
+    tamanho_buffer = argc > 1 ? leer_tamano(argv[1]) : REPETICIONES;
+    int colectiva = argc > 2 && strcmp(argv[2], "colectiva") == 0;
+    if (tamanho_buffer <= 0) {
+        if (mirango == 0) {
+            fprintf(stderr, "ERROR: El tamao por proceso debe ser positivo.\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    long long llamadas = (tamanho_buffer + TROZO_MAX_ES - 1) / TROZO_MAX_ES;
+    double megas_totales = (double)tamanho_buffer * numprocs / (1024.0 * 1024.0);
+
     // Barrera para sincronizar antes de iniciar el timer
     MPI_Barrier(MPI_COMM_WORLD);
     tiempo_inicio = MPI_Wtime();  // Todos los procesos miden tiempo
@@ -39,83 +822,83 @@ int main(int argc, char* argv[]) {
         printf("Configuracion:\n");
         printf("  - Numero de procesos: %d\n", numprocs);
         printf("  - Fichero de salida: %s\n", nombre_fichero);
-        printf("  - Repeticiones por proceso: %d\n", REPETICIONES);
+        printf("  - Bytes por proceso: %lld\n", tamanho_buffer);
+        printf("  - Acceso: %s\n", colectiva ? "colectivo (write_at_all / read_at_all)"
+            : "independiente (write_at / read_at)");
+        printf("  - Pistas MPI-IO configuradas: %d\n", pistas_numero(pistas));
         printf("  - Formato: ASCII editable\n\n");
     }
 
     // PREPARAR DATOS PARA ESCRITURA
-    tamanho_buffer = REPETICIONES;
-    buffer_escritura = (char*)malloc(tamanho_buffer * sizeof(char));
-    buffer_lectura = (char*)malloc(tamanho_buffer * sizeof(char));
+    buffer = (char*)malloc((size_t)tamanho_buffer * sizeof(char));
 
     // Verificacin mejorada de memoria
-    if (buffer_escritura == NULL || buffer_lectura == NULL) {
-        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para los buffers.\n",
-            mirango);
-
-        // Liberar memoria parcialmente asignada
-        if (buffer_escritura != NULL) free(buffer_escritura);
-        if (buffer_lectura != NULL) free(buffer_lectura);
-
+    if (buffer == NULL) {
+        fprintf(stderr, "[Proceso %d] ERROR: No se pudo asignar memoria para el buffer (%lld bytes).\n",
+            mirango, tamanho_buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
 
     // Llenar el buffer con el rango convertido a ASCII
-    for (int i = 0; i < REPETICIONES; i++) {
-        if (mirango < 10) {
-            buffer_escritura[i] = (char)(mirango + 48); // 0 -9
-        }
-        else {
-            buffer_escritura[i] = (char)(mirango + 55); // A-Z
-        }
-    }
+    char caracter = mirango < 10 ? (char)(mirango + 48)   // 0 -9
+        : (char)(mirango + 55);                            // A-Z
+    memset(buffer, caracter, (size_t)tamanho_buffer);
+
     // ABRIR EL FICHERO EN MODO ESCRITURA
     int resultado = MPI_File_open(MPI_COMM_WORLD,nombre_fichero,
-        MPI_MODE_CREATE | MPI_MODE_WRONLY,MPI_INFO_NULL,&fh);
+        MPI_MODE_CREATE | MPI_MODE_WRONLY,pistas,&fh);
 
     if (resultado != MPI_SUCCESS) {
         if (mirango == 0) {
             fprintf(stderr, "ERROR: No se pudo abrir el fichero para escritura.\n");
         }
-        free(buffer_escritura);
-        free(buffer_lectura);
+        free(buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
+    // Pistas que ha aplicado realmente la implementacin
+    if (mirango == 0 && pistas_numero(pistas) > 0) {
+        printf("Pistas MPI-IO efectivas:\n");
+        pistas_imprimir(fh, stdout, "  - ");
+        printf("\n");
+    }
+    // Ajustar el tamao por si quedaba un fichero ms largo de otra ejecucin
+    MPI_File_set_size(fh, (MPI_Offset)tamanho_buffer * numprocs);
+
     // DEFINIR LA VISTA DEL FICHERO PARA CADA PROCESO
-    desplazamiento = (MPI_Offset)(mirango * REPETICIONES);
+    desplazamiento = (MPI_Offset)mirango * tamanho_buffer;
 
     // Pasar "native" directamente sin cast
     resultado = MPI_File_set_view(fh,desplazamiento,MPI_CHAR,MPI_CHAR,(char*)"native",
-        MPI_INFO_NULL);
+        pistas);
 
     if (resultado != MPI_SUCCESS) {
         if (mirango == 0) {
             fprintf(stderr, "ERROR: No se pudo establecer la vista del fichero.\n");
         }
         MPI_File_close(&fh);
-        free(buffer_escritura);
-        free(buffer_lectura);
+        free(buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
     // ESCRITURA PARALELA EN EL FICHERO
-    resultado = MPI_File_write_at(fh,0,buffer_escritura,tamanho_buffer,
-        MPI_CHAR,&estado);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_escritura = MPI_Wtime();
+    resultado = transferir(fh, buffer, tamanho_buffer, llamadas, 1, colectiva, &estado);
     if (resultado != MPI_SUCCESS) {
         fprintf(stderr, "[Proceso %d] ERROR: Fallo en la escritura.\n", mirango);
         MPI_File_close(&fh);
-        free(buffer_escritura);
-        free(buffer_lectura);
+        free(buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
-    printf("[Proceso %d] Escritura completada: %d caracteres '%c' escritos.\n",
-        mirango, REPETICIONES, buffer_escritura[0]);
-    fflush(stdout);
-    // CERRAR EL FICHERO DESPUES DE ESCRITURA
+    salida_printf(&salida, SALIDA_PROCESOS, "[Proceso %d] Escritura completada: %lld caracteres '%c' escritos.\n",
+        mirango, tamanho_buffer, caracter);
+    // CERRAR EL FICHERO DESPUES DE ESCRITURA (el cierre vuelca los datos)
     MPI_File_close(&fh);
+    t_escritura = MPI_Wtime() - t_escritura;
+    salida_volcar(&salida, stdout);
     // Sincronizar TODOS los procesos antes de continuar
     MPI_Barrier(MPI_COMM_WORLD);
     if (mirango == 0) {
@@ -125,69 +908,79 @@ int main(int argc, char* argv[]) {
     // Segunda barrera para asegurar que el mensaje se imprime
     MPI_Barrier(MPI_COMM_WORLD);
     // ABRIR EL FICHERO EN MODO LECTURA
+    double t_lectura = MPI_Wtime();
     resultado = MPI_File_open(MPI_COMM_WORLD,nombre_fichero,MPI_MODE_RDONLY,
-        MPI_INFO_NULL,&fh);
+        pistas,&fh);
     if (resultado != MPI_SUCCESS) {
         if (mirango == 0) {
             fprintf(stderr, "ERROR: No se pudo abrir el fichero para lectura.\n");
         }
-        free(buffer_escritura);
-        free(buffer_lectura);
+        free(buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
     // DEFINIR LA VISTA PARA LECTURA
     resultado = MPI_File_set_view(fh,desplazamiento,MPI_CHAR,MPI_CHAR,
-        (char*)"native",MPI_INFO_NULL);
+        (char*)"native",pistas);
     if (resultado != MPI_SUCCESS) {
         if (mirango == 0) {
             fprintf(stderr, "ERROR: No se pudo establecer la vista de lectura.\n");
         }
         MPI_File_close(&fh);
-        free(buffer_escritura);
-        free(buffer_lectura);
+        free(buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
-    // LECTURA PARALELA DEL FICHERO
-    resultado = MPI_File_read_at(fh,0,buffer_lectura,tamanho_buffer,MPI_CHAR,&estado);
+    // LECTURA PARALELA DEL FICHERO (sobre el mismo buffer, borrado antes)
+    memset(buffer, 0, (size_t)tamanho_buffer);
+    resultado = transferir(fh, buffer, tamanho_buffer, llamadas, 0, colectiva, &estado);
     if (resultado != MPI_SUCCESS) {
         fprintf(stderr, "[Proceso %d] ERROR: Fallo en la lectura.\n", mirango);
         MPI_File_close(&fh);
-        free(buffer_escritura);
-        free(buffer_lectura);
+        free(buffer);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return 1;
     }
-    // MOSTRAR LOS DATOS LEDOS DE FORMA ORDENADA
-    for (int i = 0; i < numprocs; i++) {
-        if (mirango == i) {
-            printf("[Proceso %d] Lectura completada. Datos leidos: ", mirango);
-            for (int j = 0; j < tamanho_buffer; j++) {
-                printf("%c", buffer_lectura[j]);
-            }
-            printf("\n");
-            fflush(stdout);
-        }
-        MPI_Barrier(MPI_COMM_WORLD);
-    }
-    // CERRAR EL FICHERO Y LIBERAR RECURSOS
+    // CERRAR EL FICHERO
     MPI_File_close(&fh);
+    t_lectura = MPI_Wtime() - t_lectura;
+
+    // COMPROBAR Y MOSTRAR LOS DATOS LEDOS DE FORMA ORDENADA
+    long long erroneos = 0;
+    for (long long j = 0; j < tamanho_buffer; j++) {
+        if (buffer[j] != caracter) erroneos++;
+    }
+    int mostrados = tamanho_buffer < MAX_IMPRESION ? (int)tamanho_buffer : MAX_IMPRESION;
+    salida_printf(&salida, SALIDA_PROCESOS, "[Proceso %d] Lectura completada. Datos leidos: %.*s%s (%lld erroneos)\n",
+        mirango, mostrados, buffer, tamanho_buffer > MAX_IMPRESION ? "..." : "", erroneos);
+    salida_volcar(&salida, stdout);
+
+    // Tiempos del proceso ms lento y errores totales
+    double tiempos[2] = { t_escritura, t_lectura }, maximos[2];
+    long long erroneos_totales;
+    MPI_Reduce(tiempos, maximos, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&erroneos, &erroneos_totales, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
     // Medir tiempo antes de la barrera final
     MPI_Barrier(MPI_COMM_WORLD);
     tiempo_fin = MPI_Wtime();
     if (mirango == 0) {
         printf("RESUMEN:\n");
         printf("  - Fichero generado: %s\n", nombre_fichero);
-        printf("  - Tamao total: %d bytes (%d procesos  %d caracteres)\n",
-            numprocs * REPETICIONES, numprocs, REPETICIONES);
-        printf("  - Contenido: Cada proceso escribio su rango %d veces\n", REPETICIONES);
+        printf("  - Tamao total: %lld bytes (%d procesos  %lld caracteres)\n",
+            (long long)numprocs * tamanho_buffer, numprocs, tamanho_buffer);
+        printf("  - Contenido: Cada proceso escribio su rango %lld veces\n", tamanho_buffer);
+        printf("  - Escritura: %.6f s, %.2f MB/s\n", maximos[0], megas_totales / maximos[0]);
+        printf("  - Lectura:   %.6f s, %.2f MB/s\n", maximos[1], megas_totales / maximos[1]);
+        printf("  - Comprobacion: %s (%lld bytes erroneos)\n", erroneos_totales == 0 ? "OK" : "ERROR",
+            erroneos_totales);
         printf("  - Tiempo total: %.6f segundos\n", tiempo_fin - tiempo_inicio);
         printf("\nPuedes abrir '%s' con un editor de texto para ver el resultado.\n",nombre_fichero);
     }
     // Liberar memoria antes de finalizar
-    free(buffer_escritura);
-    free(buffer_lectura);
+    free(buffer);
+    MPI_Info_free(&pistas);
+    salida_liberar(&salida);
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
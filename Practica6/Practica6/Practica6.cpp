@@ -28,6 +28,33 @@
   - Evita esperas innecesarias
   - Mejora el rendimiento en aplicaciones complejas
 
+  GRANJA DE TAREAS (REPARTO DINMICO):
+    mpiexec -n P practica6.exe granja [tareas] [ventana] [coste] [semilla]
+  - El proceso 0 hace de maestro y reparte 'tareas' factoriales de coste
+    variable entre los P-1 trabajadores a medida que terminan: cada resultado
+    llega con MPI_Recv(MPI_ANY_SOURCE) y el maestro responde a ese mismo
+    trabajador con la siguiente tarea
+  - Cada trabajador tiene hasta 'ventana' tareas asignadas a la vez, con sus
+    MPI_Irecv ya publicados, para no quedarse parado entre una tarea y la
+    siguiente mientras el resultado viaja al maestro
+  - 'coste' escala el trabajo: la tarea del nmero n repite el factorial
+    costen veces, as que unas tareas cuestan hasta 20 veces ms que otras
+  Al final muestra las tareas y el tiempo ocupado de cada trabajador y lo
+  compara con lo que habra tardado un reparto esttico por bloques.
+
+  PETICIONES POR LOTES:
+    mpiexec -n P practica6.exe lotes [peticiones] [B] [K]
+  - En vez de un MPI_INT por MPI_Isend, el proceso 0 agrupa hasta B nmeros
+    por mensaje en un anillo de K buffers por consumidor (procesos 1 a P-1) y
+    mantiene hasta K lotes en vuelo con cada uno
+  - Cada consumidor tiene K MPI_Irecv publicados y devuelve los factoriales
+    de cada lote con MPI_Isend; el productor los recoge con MPI_Testsome
+    mientras sigue generando lotes
+  Se ejecuta primero con B = K = 1 (un nmero por mensaje, como el modo
+  interactivo) y despus con los valores pedidos, y se comparan las
+  peticiones por segundo. Con peticiones tan baratas el coste lo pone cada
+  mensaje, no el clculo.
+
   REQUISITOS:
   - Compatible con Visual Studio + DeinoMPI
   - Mnimo 2 procesos (proceso 0 y proceso 1)
@@ -37,6 +64,9 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "aleatorio.h"
 
 // Funcin para calcular el factorial de un nmero
 unsigned long long calcular_factorial(int n) {
@@ -50,6 +80,480 @@ unsigned long long calcular_factorial(int n) {
     return resultado;
 }
 
+// ---------------------------------------------------------------------------
+// Granja de tareas: el proceso 0 reparte factoriales a demanda
+// ---------------------------------------------------------------------------
+
+#define GRANJA_TAREAS 10000
+#define GRANJA_VENTANA 4
+#define GRANJA_COSTE 2000
+#define ETIQUETA_TAREA 1
+#define ETIQUETA_RESULTADO 2
+#define ETIQUETA_FIN 3
+
+// Se enva como 2 MPI_INT
+typedef struct {
+    int id;
+    int numero;
+} Tarea;
+
+typedef struct {
+    int id;
+    unsigned long long factorial;
+    double segundos;               // Tiempo de clculo en el trabajador
+} Resultado;
+
+MPI_Datatype crear_tipo_resultado(void)
+{
+    int longitudes[3] = { 1, 1, 1 };
+    MPI_Aint desplazamientos[3] = { offsetof(Resultado, id), offsetof(Resultado, factorial),
+        offsetof(Resultado, segundos) };
+    MPI_Datatype tipos[3] = { MPI_INT, MPI_UNSIGNED_LONG_LONG, MPI_DOUBLE };
+    MPI_Datatype tipo;
+    MPI_Type_create_struct(3, longitudes, desplazamientos, tipos, &tipo);
+    MPI_Type_commit(&tipo);
+    return tipo;
+}
+
+// Coste heterogneo: el factorial de 'numero' se repite costenumero veces
+unsigned long long trabajo_tarea(int numero, int coste)
+{
+    volatile int n = numero;       // Obliga a repetir el clculo en cada vuelta
+    long long repeticiones = (long long)coste * numero;
+    unsigned long long resultado = calcular_factorial(n);
+    for (long long r = 1; r < repeticiones; r++) {
+        resultado = calcular_factorial(n);
+    }
+    return resultado;
+}
+
+/*
+   Enva una tarea (o la seal de fin) al trabajador. Cada trabajador tiene
+   'ventana' huecos de envo que se usan por turno; antes de reutilizar uno
+   se espera a su envo anterior, que ya habr terminado porque el trabajador
+   devolvi ese resultado. Los datos salen de la lista de tareas, que no
+   cambia, as que no hace falta copiarlos.
+*/
+void granja_enviar(const Tarea* t, int etiqueta, int trabajador, int ventana, MPI_Request* envios, int* enviadas)
+{
+    MPI_Request* hueco = &envios[trabajador * ventana + enviadas[trabajador] % ventana];
+    MPI_Wait(hueco, MPI_STATUS_IGNORE);
+    MPI_Isend((void*)t, 2, MPI_INT, trabajador, etiqueta, MPI_COMM_WORLD, hueco);
+    enviadas[trabajador]++;
+}
+
+void granja_maestro(int tareas, int ventana, int coste, semilla_t semilla, MPI_Datatype tipo_resultado)
+{
+    int numprocs;
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    int trabajadores = numprocs - 1;
+
+    Tarea* lista = (Tarea*)malloc((size_t)tareas * sizeof(Tarea));
+    double* segundos = (double*)malloc((size_t)tareas * sizeof(double));
+    MPI_Request* envios = (MPI_Request*)malloc((size_t)numprocs * ventana * sizeof(MPI_Request));
+    int* enviadas = (int*)calloc(numprocs, sizeof(int));
+    int* pendientes = (int*)calloc(numprocs, sizeof(int));
+    int* hechas = (int*)calloc(numprocs, sizeof(int));
+    double* ocupado = (double*)calloc(numprocs, sizeof(double));
+    if (lista == NULL || segundos == NULL || envios == NULL || enviadas == NULL || pendientes == NULL
+        || hechas == NULL || ocupado == NULL) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para %d tareas.\n", tareas);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int i = 0; i < numprocs * ventana; i++) {
+        envios[i] = MPI_REQUEST_NULL;
+    }
+    for (int i = 0; i < tareas; i++) {
+        lista[i].id = i;
+        lista[i].numero = aleatorio_entero(semilla, i, 1, 20);
+    }
+    const Tarea fin = { -1, 0 };
+
+    printf("Granja de tareas: %d tareas, %d trabajadores, ventana %d, coste %d, semilla %llu\n",
+        tareas, trabajadores, ventana, coste, semilla);
+    fflush(stdout);
+
+    double t0 = MPI_Wtime();
+    // Carga inicial por turnos, para que con pocas tareas todos reciban alguna
+    int siguiente = 0;
+    for (int k = 0; k < ventana; k++) {
+        for (int w = 1; w <= trabajadores && siguiente < tareas; w++) {
+            granja_enviar(&lista[siguiente++], ETIQUETA_TAREA, w, ventana, envios, enviadas);
+            pendientes[w]++;
+        }
+    }
+    int activos = 0;
+    for (int w = 1; w <= trabajadores; w++) {
+        if (pendientes[w] > 0) {
+            activos++;
+        }
+        else {
+            granja_enviar(&fin, ETIQUETA_FIN, w, ventana, envios, enviadas);
+        }
+    }
+
+    // Cada resultado libera un hueco del trabajador que lo enva: se rellena
+    // con la siguiente tarea o, si ya no quedan y no tiene ms pendientes, se
+    // le despide
+    long long errores = 0;
+    while (activos > 0) {
+        Resultado r;
+        MPI_Status estado;
+        MPI_Recv(&r, 1, tipo_resultado, MPI_ANY_SOURCE, ETIQUETA_RESULTADO, MPI_COMM_WORLD, &estado);
+        int w = estado.MPI_SOURCE;
+        pendientes[w]--;
+        hechas[w]++;
+        ocupado[w] += r.segundos;
+        segundos[r.id] = r.segundos;
+        if (r.factorial != calcular_factorial(lista[r.id].numero)) {
+            errores++;
+        }
+        if (siguiente < tareas) {
+            granja_enviar(&lista[siguiente++], ETIQUETA_TAREA, w, ventana, envios, enviadas);
+            pendientes[w]++;
+        }
+        else if (pendientes[w] == 0) {
+            granja_enviar(&fin, ETIQUETA_FIN, w, ventana, envios, enviadas);
+            activos--;
+        }
+    }
+    double tiempo = MPI_Wtime() - t0;
+    MPI_Waitall(numprocs * ventana, envios, MPI_STATUSES_IGNORE);
+
+    double total_ocupado = 0.0;
+    for (int w = 1; w <= trabajadores; w++) {
+        printf("  Trabajador %3d: %8d tareas, ocupado %.4f s (%.1f%%)\n", w, hechas[w], ocupado[w],
+            100.0 * ocupado[w] / tiempo);
+        total_ocupado += ocupado[w];
+    }
+    // Con un reparto esttico por bloques el tiempo lo marca el bloque ms caro
+    double estatico = 0.0;
+    for (int w = 0; w < trabajadores; w++) {
+        long long inicio = (long long)tareas * w / trabajadores;
+        long long final = (long long)tareas * (w + 1) / trabajadores;
+        double bloque = 0.0;
+        for (long long i = inicio; i < final; i++) {
+            bloque += segundos[i];
+        }
+        if (bloque > estatico) estatico = bloque;
+    }
+    printf("Tiempo total: %.4f s (%.0f tareas/s), eficiencia %.1f%%\n", tiempo, tareas / tiempo,
+        100.0 * total_ocupado / (tiempo * trabajadores));
+    printf("Reparto estatico por bloques (estimado): %.4f s\n", estatico);
+    printf("Resultados: %s\n", errores == 0 ? "correctos" : "INCORRECTOS");
+
+    free(lista);
+    free(segundos);
+    free(envios);
+    free(enviadas);
+    free(pendientes);
+    free(hechas);
+    free(ocupado);
+}
+
+/*
+   El trabajador publica 'ventana' MPI_Irecv y los atiende en el mismo orden
+   (MPI no adelanta mensajes entre el mismo par de procesos). Tras calcular
+   una tarea enva el resultado con MPI_Isend y vuelve a publicar la
+   recepcin en ese hueco, as que siempre hay tareas esperando mientras
+   calcula.
+*/
+void granja_trabajador(int ventana, int coste, MPI_Datatype tipo_resultado)
+{
+    Tarea* tareas = (Tarea*)malloc((size_t)ventana * sizeof(Tarea));
+    Resultado* resultados = (Resultado*)malloc((size_t)ventana * sizeof(Resultado));
+    MPI_Request* recepciones = (MPI_Request*)malloc((size_t)ventana * sizeof(MPI_Request));
+    MPI_Request* envios = (MPI_Request*)malloc((size_t)ventana * sizeof(MPI_Request));
+    if (tareas == NULL || resultados == NULL || recepciones == NULL || envios == NULL) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para la ventana de tareas.\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int k = 0; k < ventana; k++) {
+        MPI_Irecv(&tareas[k], 2, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &recepciones[k]);
+        envios[k] = MPI_REQUEST_NULL;
+    }
+
+    for (long long k = 0; ; k++) {
+        int hueco = (int)(k % ventana);
+        MPI_Status estado;
+        MPI_Wait(&recepciones[hueco], &estado);
+        if (estado.MPI_TAG == ETIQUETA_FIN) {
+            break;
+        }
+        // El resultado anterior de este hueco tiene que haber salido antes de sobrescribirlo
+        MPI_Wait(&envios[hueco], MPI_STATUS_IGNORE);
+        double t0 = MPI_Wtime();
+        resultados[hueco].id = tareas[hueco].id;
+        resultados[hueco].factorial = trabajo_tarea(tareas[hueco].numero, coste);
+        resultados[hueco].segundos = MPI_Wtime() - t0;
+        MPI_Isend(&resultados[hueco], 1, tipo_resultado, 0, ETIQUETA_RESULTADO, MPI_COMM_WORLD, &envios[hueco]);
+        MPI_Irecv(&tareas[hueco], 2, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &recepciones[hueco]);
+    }
+
+    // El fin llega despus de la ltima tarea: el resto de recepciones no se completar
+    for (int k = 0; k < ventana; k++) {
+        if (recepciones[k] != MPI_REQUEST_NULL) {
+            MPI_Cancel(&recepciones[k]);
+            MPI_Wait(&recepciones[k], MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_Waitall(ventana, envios, MPI_STATUSES_IGNORE);
+    free(tareas);
+    free(resultados);
+    free(recepciones);
+    free(envios);
+}
+
+void ejecutar_granja(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    int tareas = argc > 2 ? atoi(argv[2]) : GRANJA_TAREAS;
+    int ventana = argc > 3 ? atoi(argv[3]) : GRANJA_VENTANA;
+    int coste = argc > 4 ? atoi(argv[4]) : GRANJA_COSTE;
+    if (numprocs < 2 || tareas < 0 || ventana < 1 || coste < 0) {
+        if (mirango == 0) {
+            fprintf(stderr, "Uso: mpiexec -n P practica6.exe granja [tareas] [ventana>=1] [coste] [semilla] (P >= 2)\n");
+        }
+        return;
+    }
+
+    MPI_Datatype tipo_resultado = crear_tipo_resultado();
+    if (mirango == 0) {
+        semilla_t semilla = argc > 5 ? strtoull(argv[5], NULL, 10) : aleatorio_semilla_reloj();
+        granja_maestro(tareas, ventana, coste, semilla, tipo_resultado);
+    }
+    else {
+        granja_trabajador(ventana, coste, tipo_resultado);
+    }
+    MPI_Type_free(&tipo_resultado);
+}
+
+// ---------------------------------------------------------------------------
+// Peticiones por lotes: anillo de K buffers de hasta B nmeros por consumidor
+// ---------------------------------------------------------------------------
+
+#define LOTES_PETICIONES 1000000
+#define LOTES_B 256
+#define LOTES_K 8
+
+/*
+   Los lotes de peticiones son int[B + 1] y los de resultados unsigned long
+   long[B + 1]; la posicin 0 lleva el ndice global del primer nmero, as
+   que los resultados pueden llegar en cualquier orden. El nmero del ndice
+   i se genera con aleatorio_entero(semilla, i), y el productor lo recalcula
+   para comprobar el resultado sin guardar las peticiones.
+*/
+double lotes_productor(long long peticiones, int B, int K, semilla_t semilla, long long* errores,
+    long long* mensajes)
+{
+    int numprocs;
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    int consumidores = numprocs - 1;
+    int huecos = consumidores * K;
+
+    int* envio = (int*)malloc((size_t)huecos * (B + 1) * sizeof(int));
+    unsigned long long* recepcion = (unsigned long long*)malloc((size_t)huecos * (B + 1) * sizeof(unsigned long long));
+    MPI_Request* envios = (MPI_Request*)malloc((size_t)huecos * sizeof(MPI_Request));
+    MPI_Request* recepciones = (MPI_Request*)malloc((size_t)huecos * sizeof(MPI_Request));
+    MPI_Status* estados = (MPI_Status*)malloc((size_t)huecos * sizeof(MPI_Status));
+    int* completadas = (int*)malloc((size_t)huecos * sizeof(int));
+    int* enviados = (int*)calloc(numprocs, sizeof(int));
+    int* pendientes = (int*)calloc(numprocs, sizeof(int));
+    int* despedido = (int*)calloc(numprocs, sizeof(int));
+    if (envio == NULL || recepcion == NULL || envios == NULL || recepciones == NULL || estados == NULL
+        || completadas == NULL || enviados == NULL || pendientes == NULL || despedido == NULL) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para %d lotes de %d peticiones.\n", huecos, B);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // Los resultados pueden llegar de cualquier consumidor: las recepciones se publican todas de antemano
+    for (int h = 0; h < huecos; h++) {
+        envios[h] = MPI_REQUEST_NULL;
+        MPI_Irecv(&recepcion[(size_t)h * (B + 1)], B + 1, MPI_UNSIGNED_LONG_LONG, MPI_ANY_SOURCE,
+            ETIQUETA_RESULTADO, MPI_COMM_WORLD, &recepciones[h]);
+    }
+
+    *errores = 0;
+    *mensajes = 0;
+    long long generadas = 0;
+    int activos = consumidores;
+    int turno = 0;
+    double t0 = MPI_Wtime();
+    while (1) {
+        // Generadas todas, se despide a los consumidores que ya han devuelto todos sus lotes
+        if (generadas == peticiones) {
+            for (int c = 1; c <= consumidores; c++) {
+                if (!despedido[c] && pendientes[c] == 0) {
+                    MPI_Send(NULL, 0, MPI_INT, c, ETIQUETA_FIN, MPI_COMM_WORLD);
+                    despedido[c] = 1;
+                    activos--;
+                }
+            }
+            if (activos == 0) {
+                break;
+            }
+        }
+
+        // Siguiente consumidor, por turnos, con menos de K lotes en vuelo
+        int destino = -1;
+        for (int i = 0; i < consumidores && generadas < peticiones && destino < 0; i++) {
+            int c = 1 + (turno + i) % consumidores;
+            if (pendientes[c] < K) destino = c;
+        }
+
+        // Sin hueco libre se espera a algn resultado; con hueco solo se recogen los que ya han llegado
+        int cuantas;
+        if (destino < 0) {
+            MPI_Waitsome(huecos, recepciones, &cuantas, completadas, estados);
+        }
+        else {
+            MPI_Testsome(huecos, recepciones, &cuantas, completadas, estados);
+        }
+        for (int i = 0; i < cuantas; i++) {
+            int h = completadas[i];
+            unsigned long long* lote = &recepcion[(size_t)h * (B + 1)];
+            int recibidos;
+            MPI_Get_count(&estados[i], MPI_UNSIGNED_LONG_LONG, &recibidos);
+            for (int j = 1; j < recibidos; j++) {
+                int numero = aleatorio_entero(semilla, lote[0] + j - 1, 0, 20);
+                if (lote[j] != calcular_factorial(numero)) (*errores)++;
+            }
+            pendientes[estados[i].MPI_SOURCE]--;
+            MPI_Irecv(lote, B + 1, MPI_UNSIGNED_LONG_LONG, MPI_ANY_SOURCE, ETIQUETA_RESULTADO, MPI_COMM_WORLD,
+                &recepciones[h]);
+        }
+
+        if (destino >= 0) {
+            // Al tener menos de K lotes en vuelo, el lote anterior de este hueco ya ha vuelto
+            int h = (destino - 1) * K + enviados[destino] % K;
+            int* lote = &envio[(size_t)h * (B + 1)];
+            MPI_Wait(&envios[h], MPI_STATUS_IGNORE);
+            int n = peticiones - generadas < B ? (int)(peticiones - generadas) : B;
+            lote[0] = (int)generadas;
+            for (int j = 0; j < n; j++) {
+                lote[j + 1] = aleatorio_entero(semilla, generadas + j, 0, 20);
+            }
+            MPI_Isend(lote, n + 1, MPI_INT, destino, ETIQUETA_TAREA, MPI_COMM_WORLD, &envios[h]);
+            generadas += n;
+            enviados[destino]++;
+            pendientes[destino]++;
+            (*mensajes)++;
+            turno = destino % consumidores;
+        }
+
+    }
+    double tiempo = MPI_Wtime() - t0;
+
+    for (int h = 0; h < huecos; h++) {
+        MPI_Cancel(&recepciones[h]);
+        MPI_Wait(&recepciones[h], MPI_STATUS_IGNORE);
+    }
+    MPI_Waitall(huecos, envios, MPI_STATUSES_IGNORE);
+    free(envio);
+    free(recepcion);
+    free(envios);
+    free(recepciones);
+    free(estados);
+    free(completadas);
+    free(enviados);
+    free(pendientes);
+    free(despedido);
+    return tiempo;
+}
+
+// Atiende los K lotes publicados en orden, igual que el trabajador de la granja
+void lotes_consumidor(int B, int K)
+{
+    int* peticiones = (int*)malloc((size_t)K * (B + 1) * sizeof(int));
+    unsigned long long* resultados = (unsigned long long*)malloc((size_t)K * (B + 1) * sizeof(unsigned long long));
+    MPI_Request* recepciones = (MPI_Request*)malloc((size_t)K * sizeof(MPI_Request));
+    MPI_Request* envios = (MPI_Request*)malloc((size_t)K * sizeof(MPI_Request));
+    if (peticiones == NULL || resultados == NULL || recepciones == NULL || envios == NULL) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para %d lotes de %d peticiones.\n", K, B);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int k = 0; k < K; k++) {
+        MPI_Irecv(&peticiones[(size_t)k * (B + 1)], B + 1, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &recepciones[k]);
+        envios[k] = MPI_REQUEST_NULL;
+    }
+
+    for (long long k = 0; ; k++) {
+        int hueco = (int)(k % K);
+        int* lote = &peticiones[(size_t)hueco * (B + 1)];
+        unsigned long long* resultado = &resultados[(size_t)hueco * (B + 1)];
+        MPI_Status estado;
+        MPI_Wait(&recepciones[hueco], &estado);
+        if (estado.MPI_TAG == ETIQUETA_FIN) {
+            break;
+        }
+        int recibidos;
+        MPI_Get_count(&estado, MPI_INT, &recibidos);
+        MPI_Wait(&envios[hueco], MPI_STATUS_IGNORE);
+        resultado[0] = (unsigned long long)lote[0];
+        for (int j = 1; j < recibidos; j++) {
+            resultado[j] = calcular_factorial(lote[j]);
+        }
+        MPI_Isend(resultado, recibidos, MPI_UNSIGNED_LONG_LONG, 0, ETIQUETA_RESULTADO, MPI_COMM_WORLD, &envios[hueco]);
+        MPI_Irecv(lote, B + 1, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &recepciones[hueco]);
+    }
+
+    for (int k = 0; k < K; k++) {
+        if (recepciones[k] != MPI_REQUEST_NULL) {
+            MPI_Cancel(&recepciones[k]);
+            MPI_Wait(&recepciones[k], MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_Waitall(K, envios, MPI_STATUSES_IGNORE);
+    free(peticiones);
+    free(resultados);
+    free(recepciones);
+    free(envios);
+}
+
+void ejecutar_lotes(int argc, char* argv[])
+{
+    int mirango, numprocs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    long long peticiones = argc > 2 ? atoll(argv[2]) : LOTES_PETICIONES;
+    int B = argc > 3 ? atoi(argv[3]) : LOTES_B;
+    int K = argc > 4 ? atoi(argv[4]) : LOTES_K;
+    // El ndice del primer nmero de cada lote viaja en un int
+    if (numprocs < 2 || peticiones < 0 || peticiones > 2147483647LL || B < 1 || K < 1) {
+        if (mirango == 0) {
+            fprintf(stderr, "Uso: mpiexec -n P practica6.exe lotes [peticiones] [B>=1] [K>=1] (P >= 2)\n");
+        }
+        return;
+    }
+
+    semilla_t semilla = aleatorio_semilla_reloj();
+    const int tamanos[2] = { 1, B };
+    const int profundidades[2] = { 1, K };
+    const char* nombres[2] = { "Uno a uno", "Por lotes" };
+    double tiempos[2];
+    if (mirango == 0) {
+        printf("Peticiones por lotes: %lld factoriales, %d consumidores\n", peticiones, numprocs - 1);
+    }
+    for (int modo = 0; modo < 2; modo++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (mirango == 0) {
+            long long errores, mensajes;
+            tiempos[modo] = lotes_productor(peticiones, tamanos[modo], profundidades[modo], semilla, &errores, &mensajes);
+            printf("  %s (B = %d, K = %d): %lld mensajes, %.4f s, %.0f peticiones/s, resultados %s\n",
+                nombres[modo], tamanos[modo], profundidades[modo], mensajes, tiempos[modo],
+                peticiones / tiempos[modo], errores == 0 ? "correctos" : "INCORRECTOS");
+            fflush(stdout);
+        }
+        else {
+            lotes_consumidor(tamanos[modo], profundidades[modo]);
+        }
+    }
+    if (mirango == 0) {
+        printf("Aceleracion por lotes: %.2fx\n", tiempos[0] / tiempos[1]);
+    }
+}
+
 int main(int argc, char* argv[]) {
     int mirango, numprocs;
 
@@ -69,6 +573,17 @@ int main(int argc, char* argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &mirango);
     MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
 
+    if (argc > 1 && strcmp(argv[1], "granja") == 0) {
+        ejecutar_granja(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "lotes") == 0) {
+        ejecutar_lotes(argc, argv);
+        MPI_Finalize();
+        return 0;
+    }
+
     // =========================================================================
     // FASE 2: VALIDACIN DEL NMERO DE PROCESOS
     // =========================================================================
@@ -24,6 +24,11 @@
   - Mnimo 3 procesos
   - Compatible con Visual Studio + DeinoMPI
   - Tamao N dinmico (especificado por usuario)
+
+  USO:
+  - mpiexec -n 3 Practica7.exe [semilla] [fichero.mat]
+    con fichero, la matriz original se guarda en el formato binario de
+    Comun/matriz_binaria.h
 ================================================================================
 */
 
@@ -31,6 +36,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include "aleatorio.h"
+#include "matriz_binaria.h"
+#include "pistas_es.h"
 
 // Imprime una matriz NN dinmica
 void imprimir_matriz(int **matriz, int N) {
@@ -143,16 +151,13 @@ int main(int argc, char *argv[]) {
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
 
-        // Inicializar generador aleatorio
-        srand((unsigned int)time(NULL));
+        // Semilla del generador (primer argumento o reloj): con la misma semilla
+        // se obtiene siempre la misma matriz
+        semilla_t semilla = argc > 1 ? strtoull(argv[1], NULL, 10) : aleatorio_semilla_reloj();
 
         // Inicializar matriz con valores aleatorios
-        printf("Inicializando matriz original...\n");
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                matriz_original[i][j] = rand() % 100;  // Enteros de 0 a 99
-            }
-        }
+        printf("Inicializando matriz original (semilla %llu)...\n", semilla);
+        aleatorio_rellenar(matriz_original[0], (size_t)N * N, semilla, 0, 0, 99);  // Enteros de 0 a 99
         printf("%s\n", "MATRIZ ORIGINAL:");
         imprimir_matriz(matriz_original, N);
 
@@ -222,7 +227,6 @@ int main(int argc, char *argv[]) {
         free(desplazamientos_inferior);
         MPI_Type_free(&tipo_triangular_superior);
         MPI_Type_free(&tipo_triangular_inferior);
-        liberar_matriz(matriz_original);
 
         printf("Proceso 0 ha terminado el envio.\n");
     }
@@ -346,6 +350,22 @@ int main(int argc, char *argv[]) {
         printf("[Proceso %d] No participa en este ejercicio.\n", mirango);
     }
 
+    // GUARDAR LA MATRIZ ORIGINAL EN FORMATO BINARIO (segundo argumento)
+    // Es una operacin colectiva: solo el proceso 0 tiene datos y el resto
+    // participa con una tesela vaca
+    if (argc > 2) {
+        MPI_Info pistas = pistas_cargar(MPI_COMM_WORLD);
+        int malla[2] = { 1, 1 };
+        int propia = mirango == 0 ? N : 0;
+        int resultado = matriz_escribir(MPI_COMM_WORLD, argv[2], pistas, MATRIZ_ENTERO, N, N, MATRIZ_COMPLETA,
+            malla, mirango == 0 ? matriz_original[0] : NULL, matriz_tesela(0, 0, propia, propia, N), NULL);
+        if (mirango == 0) {
+            printf("Matriz original guardada en '%s': %s\n", argv[2], matriz_mensaje(resultado));
+        }
+        MPI_Info_free(&pistas);
+    }
+    liberar_matriz(matriz_original);
+
     MPI_Finalize();
     return 0;
 }
\ No newline at end of file